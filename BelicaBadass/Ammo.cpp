@@ -21,11 +21,6 @@ AAmmo::AAmmo()
 	AmmoCollisionSphere->SetSphereRadius(50.f);
 }
 
-void AAmmo::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 void AAmmo::BeginPlay()
 {
 	Super::BeginPlay();
@@ -37,43 +32,13 @@ void AAmmo::SetItemProperties(EItemState State)
 {
 	Super::SetItemProperties(State);
 
-	switch (State)
-	{
-	case EItemState::EIS_Pickup:
-		// Set ItemMesh properties
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_EquipInterping:
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_PickedUp:
-		break;
-	case EItemState::EIS_Equipped:
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_Falling:
-		// Set ItemMesh properties
-		AmmoMesh->SetSimulatePhysics(true);
-		AmmoMesh->SetEnableGravity(true);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		AmmoMesh->SetCollisionResponseToChannel(ECC_WorldStatic, ECR_Block);
-		break;
-	default:
-		break;
-	}
+	// The AmmoMesh keeps its settings once the Ammo is picked up
+	const FItemStateProfile* Profile{ GetStateProfile(State) };
+	if (Profile == nullptr || State == EItemState::EIS_PickedUp) return;
+
+	// Falling leaves the AmmoMesh's visibility as it was
+	if (State != EItemState::EIS_Falling) AmmoMesh->SetVisibility(true);
+	ApplyCollisionProfile(AmmoMesh, *Profile->Mesh);
 }
 
 void AAmmo::AmmoSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
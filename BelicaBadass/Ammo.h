@@ -15,8 +15,6 @@ class BELICABADASS_API AAmmo : public AItem
 public:
 	AAmmo();
 
-	virtual void Tick(float DeltaTime) override;
-
 	virtual void EnableCustomDepth() override;
 
 	virtual void DisableCustomDepth() override;
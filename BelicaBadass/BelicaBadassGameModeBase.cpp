@@ -2,4 +2,18 @@
 
 
 #include "BelicaBadassGameModeBase.h"
+#include "Enemy.h"
+#include "EnemyPoolSubsystem.h"
 
+void ABelicaBadassGameModeBase::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UEnemyPoolSubsystem* EnemyPool{ GetWorld()->GetSubsystem<UEnemyPoolSubsystem>() };
+	if (EnemyPool == nullptr) return;
+
+	for (const auto& PrewarmPair : EnemyPoolPrewarmCounts)
+	{
+		EnemyPool->Prewarm(PrewarmPair.Key, PrewarmPair.Value);
+	}
+}
@@ -6,6 +6,8 @@
 #include "GameFramework/GameModeBase.h"
 #include "BelicaBadassGameModeBase.generated.h"
 
+class AEnemy;
+
 /**
  * 
  */
@@ -13,5 +15,12 @@ UCLASS()
 class BELICABADASS_API ABelicaBadassGameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
-	
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	/* Number of deactivated enemies of each class to spawn into the enemy pool at map load */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Enemy Pool", meta = (AllowPrivateAccess = "true"))
+	TMap<TSubclassOf<AEnemy>, int32> EnemyPoolPrewarmCounts;
 };
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatUISubsystem.h"
+#include "Blueprint/UserWidget.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "SceneView.h"
+#include "HitNumberWidget.h"
+#include "EnemyHealthBarWidget.h"
+#include "Enemy.h"
+#include "BelicaBadass.h"
+
+DECLARE_CYCLE_STAT(TEXT("Combat UI Tick"), STAT_CombatUITick, STATGROUP_BelicaBadass);
+
+void UCombatUISubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatUITick);
+
+	if (HitNumbers.Num() == 0 && HealthBars.Num() == 0) return;
+
+	const double Now{ GetWorld()->GetTimeSeconds() };
+
+	// Expire entries by timestamp
+	for (int32 i = HitNumbers.Num() - 1; i >= 0; i--)
+	{
+		FHitNumberEntry& Entry{ HitNumbers[i] };
+		if (Entry.ExpireTime > Now && IsValid(Entry.Widget)) continue;
+
+		if (Entry.bPooled) ReleaseWidget(Entry.Widget);
+		else if (IsValid(Entry.Widget)) Entry.Widget->RemoveFromParent();
+		HitNumbers.RemoveAtSwap(i, 1, false);
+	}
+
+	for (int32 i = HealthBars.Num() - 1; i >= 0; i--)
+	{
+		FHealthBarEntry& Entry{ HealthBars[i] };
+		AEnemy* Enemy{ Entry.Enemy.Get() };
+		if (Entry.ExpireTime > Now && Enemy) continue;
+
+		if (Entry.Widget) ReleaseWidget(Entry.Widget);
+		else if (Enemy) Enemy->HideHealthBar();
+		HealthBars.RemoveAtSwap(i, 1, false);
+	}
+
+	// Build the view projection once for every widget
+	APlayerController* PlayerController{ GetWorld()->GetFirstPlayerController() };
+	ULocalPlayer* LocalPlayer{ PlayerController ? PlayerController->GetLocalPlayer() : nullptr };
+	if (LocalPlayer == nullptr || LocalPlayer->ViewportClient == nullptr) return;
+
+	FSceneViewProjectionData ProjectionData;
+	if (!LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, ProjectionData)) return;
+
+	const FMatrix ViewProjectionMatrix{ ProjectionData.ComputeViewProjectionMatrix() };
+	const FIntRect ViewRect{ ProjectionData.GetConstrainedViewRect() };
+
+	FVector2D ScreenPosition;
+	for (const FHitNumberEntry& Entry : HitNumbers)
+	{
+		if (FSceneView::ProjectWorldToScreen(Entry.Location, ViewRect, ViewProjectionMatrix, ScreenPosition)) Entry.Widget->SetPositionInViewport(ScreenPosition);
+	}
+
+	for (const FHealthBarEntry& Entry : HealthBars)
+	{
+		if (Entry.Widget == nullptr) continue;
+
+		const FVector Location{ Entry.Enemy->GetActorLocation() + Entry.Offset };
+		if (FSceneView::ProjectWorldToScreen(Location, ViewRect, ViewProjectionMatrix, ScreenPosition)) Entry.Widget->SetPositionInViewport(ScreenPosition);
+	}
+}
+
+TStatId UCombatUISubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatUISubsystem, STATGROUP_Tickables);
+}
+
+void UCombatUISubsystem::Deinitialize()
+{
+	HitNumbers.Empty();
+	HealthBars.Empty();
+	WidgetPools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCombatUISubsystem::ShowHitNumber(TSubclassOf<UHitNumberWidget> WidgetClass, int32 Damage, const FVector& Location, bool bHeadShot, float Lifetime)
+{
+	UHitNumberWidget* HitNumber{ Cast<UHitNumberWidget>(AcquireWidget(WidgetClass)) };
+	if (HitNumber == nullptr) return;
+
+	HitNumber->SetHitNumber(Damage, bHeadShot);
+
+	FHitNumberEntry& Entry{ HitNumbers.AddDefaulted_GetRef() };
+	Entry.Widget = HitNumber;
+	Entry.Location = Location;
+	Entry.ExpireTime = GetWorld()->GetTimeSeconds() + Lifetime;
+	Entry.bPooled = true;
+}
+
+void UCombatUISubsystem::AddHitNumber(UUserWidget* HitNumber, const FVector& Location, float Lifetime)
+{
+	if (HitNumber == nullptr) return;
+
+	FHitNumberEntry& Entry{ HitNumbers.AddDefaulted_GetRef() };
+	Entry.Widget = HitNumber;
+	Entry.Location = Location;
+	Entry.ExpireTime = GetWorld()->GetTimeSeconds() + Lifetime;
+	Entry.bPooled = false;
+}
+
+void UCombatUISubsystem::ShowHealthBar(AEnemy* Enemy, TSubclassOf<UEnemyHealthBarWidget> WidgetClass, float HealthPercent, const FVector& Offset, float Lifetime)
+{
+	if (Enemy == nullptr) return;
+
+	FHealthBarEntry* Entry{ HealthBars.FindByPredicate([Enemy](const FHealthBarEntry& Bar) { return Bar.Enemy == Enemy; }) };
+	if (Entry == nullptr)
+	{
+		Entry = &HealthBars.AddDefaulted_GetRef();
+		Entry->Enemy = Enemy;
+		if (WidgetClass) Entry->Widget = Cast<UEnemyHealthBarWidget>(AcquireWidget(WidgetClass));
+	}
+
+	Entry->Offset = Offset;
+	Entry->ExpireTime = GetWorld()->GetTimeSeconds() + Lifetime;
+	if (Entry->Widget) Entry->Widget->SetHealthPercent(HealthPercent);
+}
+
+void UCombatUISubsystem::HideHealthBar(AEnemy* Enemy)
+{
+	const int32 Index{ HealthBars.IndexOfByPredicate([Enemy](const FHealthBarEntry& Bar) { return Bar.Enemy == Enemy; }) };
+	if (Index == INDEX_NONE) return;
+
+	if (HealthBars[Index].Widget) ReleaseWidget(HealthBars[Index].Widget);
+	HealthBars.RemoveAtSwap(Index, 1, false);
+}
+
+UUserWidget* UCombatUISubsystem::AcquireWidget(TSubclassOf<UUserWidget> WidgetClass)
+{
+	if (WidgetClass == nullptr) return nullptr;
+
+	FCombatWidgetPool& Pool{ WidgetPools.FindOrAdd(WidgetClass) };
+	while (Pool.FreeWidgets.Num() > 0)
+	{
+		UUserWidget* Widget{ Pool.FreeWidgets.Pop(false) };
+		if (IsValid(Widget))
+		{
+			Widget->SetVisibility(ESlateVisibility::HitTestInvisible);
+			return Widget;
+		}
+	}
+
+	APlayerController* PlayerController{ GetWorld()->GetFirstPlayerController() };
+	if (PlayerController == nullptr) return nullptr;
+
+	UUserWidget* Widget{ CreateWidget<UUserWidget>(PlayerController, WidgetClass) };
+	if (Widget)
+	{
+		Widget->AddToViewport();
+		Widget->SetVisibility(ESlateVisibility::HitTestInvisible);
+	}
+	return Widget;
+}
+
+void UCombatUISubsystem::ReleaseWidget(UUserWidget* Widget)
+{
+	if (!IsValid(Widget)) return;
+
+	Widget->SetVisibility(ESlateVisibility::Collapsed);
+	WidgetPools.FindOrAdd(Widget->GetClass()).FreeWidgets.Add(Widget);
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatUISubsystem.generated.h"
+
+class UUserWidget;
+class UHitNumberWidget;
+class UEnemyHealthBarWidget;
+class AEnemy;
+
+USTRUCT()
+struct FCombatWidgetPool
+{
+	GENERATED_BODY()
+
+	/* Widgets already in the viewport and collapsed, ready to be shown again */
+	UPROPERTY()
+	TArray<UUserWidget*> FreeWidgets;
+};
+
+USTRUCT()
+struct FHitNumberEntry
+{
+	GENERATED_BODY()
+
+	/* Widget displaying the damage */
+	UPROPERTY()
+	UUserWidget* Widget{ nullptr };
+
+	/* World location the number is pinned to */
+	FVector Location{ FVector::ZeroVector };
+
+	/* World time at which the number is removed */
+	double ExpireTime{ 0.0 };
+
+	/* True when the widget came from our pool and should go back to it */
+	bool bPooled{ false };
+};
+
+USTRUCT()
+struct FHealthBarEntry
+{
+	GENERATED_BODY()
+
+	/* Enemy the bar follows */
+	TWeakObjectPtr<AEnemy> Enemy;
+
+	/* Pooled bar widget, null when the Enemy's Blueprint draws its own bar */
+	UPROPERTY()
+	UEnemyHealthBarWidget* Widget{ nullptr };
+
+	/* Offset from the Enemy's location the bar is drawn at */
+	FVector Offset{ FVector::ZeroVector };
+
+	/* World time at which the bar is hidden */
+	double ExpireTime{ 0.0 };
+};
+
+/**
+ * Owns the hit numbers and health bars of every Enemy: widgets are pooled, all of them are
+ * projected to the screen in one pass per frame, and entries expire by timestamp instead of timers
+ */
+UCLASS()
+class BELICABADASS_API UCombatUISubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual void Deinitialize() override;
+
+	// Shows a pooled hit number of WidgetClass at Location for Lifetime seconds
+	void ShowHitNumber(TSubclassOf<UHitNumberWidget> WidgetClass, int32 Damage, const FVector& Location, bool bHeadShot, float Lifetime);
+
+	// Tracks a hit number widget created elsewhere and removes it from its parent once it expires
+	void AddHitNumber(UUserWidget* HitNumber, const FVector& Location, float Lifetime);
+
+	// Shows or refreshes Enemy's health bar; without a WidgetClass only the expiry is tracked and AEnemy::HideHealthBar is called
+	void ShowHealthBar(AEnemy* Enemy, TSubclassOf<UEnemyHealthBarWidget> WidgetClass, float HealthPercent, const FVector& Offset, float Lifetime);
+
+	// Hides Enemy's health bar right away
+	void HideHealthBar(AEnemy* Enemy);
+
+protected:
+	UUserWidget* AcquireWidget(TSubclassOf<UUserWidget> WidgetClass);
+
+	void ReleaseWidget(UUserWidget* Widget);
+
+private:
+	/* Hit numbers currently on screen */
+	UPROPERTY()
+	TArray<FHitNumberEntry> HitNumbers;
+
+	/* Health bars currently on screen, one per Enemy */
+	UPROPERTY()
+	TArray<FHealthBarEntry> HealthBars;
+
+	/* Collapsed widgets by class */
+	UPROPERTY()
+	TMap<UClass*, FCombatWidgetPool> WidgetPools;
+};
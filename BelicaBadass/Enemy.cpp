@@ -14,12 +14,23 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/BoxComponent.h"
 #include "Engine/SkeletalMeshSocket.h"
+#include "FXPoolSubsystem.h"
+#include "CombatUISubsystem.h"
+#include "EnemySignificanceSubsystem.h"
+#include "EnemyPoolSubsystem.h"
+#include "EnemyCrowdSubsystem.h"
+#include "BrainComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
 
 // Sets default values
-AEnemy::AEnemy() :
+AEnemy::AEnemy(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName)),
 	Health(100.f),
 	MaxHealth(100.f),
+	LastHitZone(EHitZone::EHZ_Body),
 	HealthBarDisplayTime(4.f),
+	HealthBarOffset(FVector(0.f, 0.f, 100.f)),
 	bCanHitReact(true),
 	HitReactTimeMin(0.5f),
 	HitReactTimeMax(0.75f),
@@ -36,11 +47,18 @@ AEnemy::AEnemy() :
 	bCanAttack(true),
 	AttackWaitTime(1.f),
 	bDying(false),
-	DeathTime(4.f)
+	DeathTime(4.f),
+	LastDamageTime(-1000.f),
+	CombatMemoryTime(5.f),
+	CombatDistance(2500.f),
+	CrowdAgentHandle(INDEX_NONE)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	// Enemies spawned by the enemy pool need a controller as well as the ones placed in the level
+	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+
 	AgroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
 	AgroSphere->SetupAttachment(GetRootComponent());
 
@@ -52,6 +70,12 @@ AEnemy::AEnemy() :
 
 	RightWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("RightWeaponBox"));
 	RightWeaponCollision->SetupAttachment(GetMesh(), FName("RightWeaponBone"));
+
+	// Let the mesh skip anim updates based on screen size, the significance manager sets the rest
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+
+	// Only montages keep ticking off screen so death and attack notifies still fire
+	GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
 }
 
 // Called when the game starts or when spawned
@@ -63,7 +87,26 @@ void AEnemy::BeginPlay()
 	
 	SetCollisionResponses();
 
+	if (HitZones) CompiledHitZones = HitZones->GetCompiledHitZones(GetMesh());
+
 	StartPatrol();
+
+	UEnemySignificanceSubsystem* Significance{ GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>() };
+	if (Significance) Significance->RegisterEnemy(this);
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UEnemyCrowdSubsystem* Crowd{ GetWorld()->GetSubsystem<UEnemyCrowdSubsystem>() };
+	if (Crowd && CrowdAgentHandle != INDEX_NONE) Crowd->OnAgentKilled(CrowdAgentHandle);
+
+	UEnemySignificanceSubsystem* Significance{ GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>() };
+	if (Significance) Significance->UnregisterEnemy(this);
+
+	UCombatUISubsystem* CombatUI{ GetWorld()->GetSubsystem<UCombatUISubsystem>() };
+	if (CombatUI) CombatUI->HideHealthBar(this);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AEnemy::SetComponentOverlaps()
@@ -102,22 +145,124 @@ void AEnemy::StartPatrol()
 {
 	EnemyController = Cast<AEnemyController>(GetController());
 
+	if (EnemyController)
+	{
+		SetPatrolPointKeys();
+		EnemyController->RunBehaviorTree(BehaviorTree);
+		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), bCanAttack);
+	}
+}
+
+void AEnemy::SetPatrolPointKeys()
+{
+	if (EnemyController == nullptr) return;
+
 	const FVector WorldPatrolPoint = UKismetMathLibrary::TransformLocation(GetActorTransform(), PatrolPoint);
 	const FVector WorldPatrolPoint2 = UKismetMathLibrary::TransformLocation(GetActorTransform(), PatrolPoint2);
 
+	EnemyController->GetBlackboardComponent()->SetValueAsVector(TEXT("PatrolPoint"), WorldPatrolPoint);
+	EnemyController->GetBlackboardComponent()->SetValueAsVector(TEXT("PatrolPoint2"), WorldPatrolPoint2);
+}
+
+void AEnemy::SetPatrolPoints(const FVector& WorldPatrolPoint, const FVector& WorldPatrolPoint2)
+{
+	PatrolPoint = UKismetMathLibrary::InverseTransformLocation(GetActorTransform(), WorldPatrolPoint);
+	PatrolPoint2 = UKismetMathLibrary::InverseTransformLocation(GetActorTransform(), WorldPatrolPoint2);
+
+	SetPatrolPointKeys();
+}
+
+void AEnemy::SetTarget(AActor* Target)
+{
+	if (EnemyController && EnemyController->GetBlackboardComponent())
+	{
+		EnemyController->GetBlackboardComponent()->SetValueAsObject(TEXT("Target"), Target);
+		UpdateSignificance();
+	}
+}
+
+void AEnemy::ResetForSpawn(const FTransform& SpawnTransform)
+{
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	// Combat state
+	Health = MaxHealth;
+	bDying = false;
+	bStunned = false;
+	bInAttackRange = false;
+	bCanAttack = true;
+	bCanHitReact = true;
+	LastHitZone = EHitZone::EHZ_Body;
+	LastDamageTime = -1000.f;
+
+	// Collision, weapon boxes only turn on during attacks
+	SetActorEnableCollision(true);
+	DeactivateLeftWeapon();
+	DeactivateRightWeapon();
+
+	// Visuals and movement
+	SetActorHiddenInGame(false);
+	SetActorTickEnabled(true);
+	GetMesh()->bPauseAnims = false;
+	if (auto AnimInstance = GetMesh()->GetAnimInstance()) AnimInstance->StopAllMontages(0.f);
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+	// Blackboard and behavior tree
+	EnemyController = Cast<AEnemyController>(GetController());
+	if (EnemyController && EnemyController->GetBrainComponent())
+	{
+		UBlackboardComponent* Blackboard{ EnemyController->GetBlackboardComponent() };
+		Blackboard->SetValueAsBool(FName("IsDead"), false);
+		Blackboard->SetValueAsBool(TEXT("Stunned"), false);
+		Blackboard->SetValueAsBool(TEXT("InAttackRange"), false);
+		Blackboard->SetValueAsBool(FName("CanAttack"), true);
+		Blackboard->ClearValue(TEXT("Target"));
+		SetPatrolPointKeys();
+
+		EnemyController->GetBrainComponent()->RestartLogic();
+	}
+	else StartPatrol();
+
+	UEnemySignificanceSubsystem* Significance{ GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>() };
+	if (Significance) Significance->RegisterEnemy(this);
+}
+
+void AEnemy::Deactivate()
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	UCombatUISubsystem* CombatUI{ GetWorld()->GetSubsystem<UCombatUISubsystem>() };
+	if (CombatUI) CombatUI->HideHealthBar(this);
+	HideHealthBar();
+
+	UEnemySignificanceSubsystem* Significance{ GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>() };
+	if (Significance) Significance->UnregisterEnemy(this);
+
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsVector(TEXT("PatrolPoint"), WorldPatrolPoint);
-		EnemyController->GetBlackboardComponent()->SetValueAsVector(TEXT("PatrolPoint2"), WorldPatrolPoint2);
-		EnemyController->RunBehaviorTree(BehaviorTree);
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), bCanAttack);
+		EnemyController->StopMovement();
+		if (EnemyController->GetBrainComponent()) EnemyController->GetBrainComponent()->StopLogic(TEXT("Pooled"));
 	}
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
+	SetActorTickEnabled(false);
+	GetMesh()->bPauseAnims = true;
 }
 
 void AEnemy::ShowHealthBar_Implementation()
 {
-	GetWorldTimerManager().ClearTimer(HealthBarTimer);
-	GetWorldTimerManager().SetTimer(HealthBarTimer, this, &AEnemy::HideHealthBar, HealthBarDisplayTime);
+	UCombatUISubsystem* CombatUI{ GetWorld()->GetSubsystem<UCombatUISubsystem>() };
+	if (CombatUI) CombatUI->ShowHealthBar(this, HealthBarWidgetClass, Health / MaxHealth, HealthBarOffset, HealthBarDisplayTime);
+}
+
+void AEnemy::ShowHitNumber_Implementation(int32 Damage, FVector HitLocation, bool bHeadShot)
+{
+	UCombatUISubsystem* CombatUI{ GetWorld()->GetSubsystem<UCombatUISubsystem>() };
+	if (CombatUI) CombatUI->ShowHitNumber(HitNumberWidgetClass, Damage, HitLocation, bHeadShot, HitNumberDestroyTime);
 }
 
 void AEnemy::Die()
@@ -125,6 +270,12 @@ void AEnemy::Die()
 	if (bDying) return;
 	bDying = true;
 
+	UEnemyCrowdSubsystem* Crowd{ GetWorld()->GetSubsystem<UEnemyCrowdSubsystem>() };
+	if (Crowd && CrowdAgentHandle != INDEX_NONE) Crowd->OnAgentKilled(CrowdAgentHandle);
+	CrowdAgentHandle = INDEX_NONE;
+
+	UCombatUISubsystem* CombatUI{ GetWorld()->GetSubsystem<UCombatUISubsystem>() };
+	if (CombatUI) CombatUI->HideHealthBar(this);
 	HideHealthBar();
 
 	auto AnimInstance = GetMesh()->GetAnimInstance();
@@ -161,30 +312,8 @@ void AEnemy::ResetHitReactTimer()
 
 void AEnemy::StoreHitNumber(UUserWidget* HitNumber, FVector Location)
 {
-	HitNumbers.Add(HitNumber, Location);
-
-	FTimerHandle HitNumberTimer;
-	FTimerDelegate HitNumberDelegate;
-	HitNumberDelegate.BindUFunction(this, FName("DestroyHitNumber"), HitNumber);
-	GetWorld()->GetTimerManager().SetTimer(HitNumberTimer, HitNumberDelegate, HitNumberDestroyTime, false);
-}
-
-void AEnemy::DestroyHitNumber(UUserWidget* HitNumber)
-{
-	HitNumbers.Remove(HitNumber);
-	HitNumber->RemoveFromParent();
-}
-
-void AEnemy::UpdateHitNumbers()
-{
-	for (auto& HitPair : HitNumbers)
-	{
-		UUserWidget* HitNumber{ HitPair.Key };
-		const FVector Location{ HitPair.Value };
-		FVector2D ScreenPosition;
-		UGameplayStatics::ProjectWorldToScreen(GetWorld()->GetFirstPlayerController(), Location, ScreenPosition);
-		HitNumber->SetPositionInViewport(ScreenPosition);
-	}
+	UCombatUISubsystem* CombatUI{ GetWorld()->GetSubsystem<UCombatUISubsystem>() };
+	if (CombatUI) CombatUI->AddHitNumber(HitNumber, Location, HitNumberDestroyTime);
 }
 
 void AEnemy::AgroSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -192,7 +321,7 @@ void AEnemy::AgroSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AA
 	if (OtherActor)
 	{
 		auto Character = Cast<AShooterCharacter>(OtherActor);
-		if (Character && EnemyController && EnemyController->GetBlackboardComponent()) EnemyController->GetBlackboardComponent()->SetValueAsObject(TEXT("Target"), Character);
+		if (Character) SetTarget(Character);
 	}
 }
 
@@ -212,6 +341,7 @@ void AEnemy::CombatRangeBeginOverlap(UPrimitiveComponent* OverlappedComponent, A
 		{
 			bInAttackRange = true;
 			if (EnemyController) EnemyController->GetBlackboardComponent()->SetValueAsBool(TEXT("InAttackRange"), bInAttackRange);
+			UpdateSignificance();
 		}
 	}
 }
@@ -324,7 +454,7 @@ void AEnemy::SpawnBlood(AShooterCharacter* Victim, FName SocketName)
 	if (TipSocket)
 	{
 		const FTransform SocketTransform{ TipSocket->GetSocketTransform(GetMesh()) };
-		if (Victim->GetBloodParticles()) UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Victim->GetBloodParticles(), SocketTransform);
+		if (Victim->GetBloodParticles()) UFXPoolSubsystem::SpawnEmitterAtLocation(this, Victim->GetBloodParticles(), SocketTransform);
 	}
 }
 
@@ -351,15 +481,15 @@ void AEnemy::FinishDeath()
 
 void AEnemy::DestroyEnemy()
 {
-	Destroy();
+	UEnemyPoolSubsystem* EnemyPool{ GetWorld()->GetSubsystem<UEnemyPoolSubsystem>() };
+	if (EnemyPool) EnemyPool->ReleaseEnemy(this);
+	else Destroy();
 }
 
 // Called every frame
 void AEnemy::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-
-	UpdateHitNumbers();
 }
 
 // Called to bind functionality to input
@@ -373,13 +503,50 @@ void AEnemy::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, ACo
 {
 	if (ImpactSound) UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
 
-	if (ImpactParticles) UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, HitResult.Location, FRotator(0.f), true);
+	if (ImpactParticles) UFXPoolSubsystem::SpawnEmitterAtLocation(this, ImpactParticles, HitResult.Location);
+}
+
+const FHitZoneInfo& AEnemy::ResolveHitZone(const FHitResult& HitResult) const
+{
+	if (CompiledHitZones.IsValid()) return CompiledHitZones->Resolve(GetMesh()->GetBoneIndex(HitResult.BoneName));
+
+	static const FHitZoneInfo BodyZone{ EHitZone::EHZ_Body, 1.f };
+	static const FHitZoneInfo HeadZone{ EHitZone::EHZ_Head, 1.f };
+	return HitResult.BoneName == HeadBone ? HeadZone : BodyZone;
+}
+
+bool AEnemy::IsInCombat() const
+{
+	if (bInAttackRange) return true;
+
+	if (GetWorld()->GetTimeSeconds() - LastDamageTime < CombatMemoryTime) return true;
+
+	// The Target key is never cleared once set, so only a target that is still close counts
+	UBlackboardComponent* Blackboard{ EnemyController ? EnemyController->GetBlackboardComponent() : nullptr };
+	const AActor* Target{ Blackboard ? Cast<AActor>(Blackboard->GetValueAsObject(TEXT("Target"))) : nullptr };
+	return Target && FVector::DistSquared(Target->GetActorLocation(), GetActorLocation()) <= FMath::Square(CombatDistance);
+}
+
+void AEnemy::UpdateSignificance()
+{
+	UEnemySignificanceSubsystem* Significance{ GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>() };
+	if (Significance) Significance->UpdateEnemy(this);
 }
 
 float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	if (EnemyController) EnemyController->GetBlackboardComponent()->SetValueAsObject(FName("Target"), DamageCauser);
 
+	LastDamageTime = GetWorld()->GetTimeSeconds();
+	UpdateSignificance();
+
+	if (DamageEvent.IsOfType(FHitZoneDamageEvent::ClassID))
+	{
+		const FHitZoneDamageEvent& HitZoneEvent{ static_cast<const FHitZoneDamageEvent&>(DamageEvent) };
+		LastHitZone = HitZoneEvent.HitZone;
+		ShowHitNumber(FMath::TruncToInt(DamageAmount), HitZoneEvent.HitInfo.Location, LastHitZone == EHitZone::EHZ_Head);
+	}
+
 	if (Health - DamageAmount <= 0.f)
 	{
 		Health = 0.f;
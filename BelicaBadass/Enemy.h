@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "BulletHitInterface.h"
+#include "HitZoneDataAsset.h"
 #include "Enemy.generated.h"
 
 class UParticleSystem;
@@ -14,6 +15,8 @@ class AEnemyController;
 class USphereComponent;
 class UBoxComponent;
 class AShooterCharacter;
+class UHitNumberWidget;
+class UEnemyHealthBarWidget;
 
 UCLASS()
 class BELICABADASS_API AEnemy : public ACharacter, public IBulletHitInterface
@@ -22,7 +25,7 @@ class BELICABADASS_API AEnemy : public ACharacter, public IBulletHitInterface
 
 public:
 	// Sets default values for this character's properties
-	AEnemy();
+	AEnemy(const FObjectInitializer& ObjectInitializer);
 
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -34,40 +37,60 @@ public:
 
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
-	UFUNCTION(BlueprintImplementableEvent)
+	// Looks up the hit zone of the bone in HitResult
+	const FHitZoneInfo& ResolveHitZone(const FHitResult& HitResult) const;
+
+	UFUNCTION(BlueprintNativeEvent)
 	void ShowHitNumber(int32 Damage, FVector HitLocation, bool bHeadShot);
+	void ShowHitNumber_Implementation(int32 Damage, FVector HitLocation, bool bHeadShot);
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void HideHealthBar();
+
+	// True while the Enemy is in attack range, was damaged recently or has its target within CombatDistance
+	bool IsInCombat() const;
+
+	// Brings a pooled Enemy back to full health at SpawnTransform and restarts its behavior tree
+	void ResetForSpawn(const FTransform& SpawnTransform);
+
+	// Hides the Enemy and stops its collision, ticking and AI so it can wait in the enemy pool
+	void Deactivate();
+
+	// Replaces the patrol points with two world locations, e.g. when promoted from the enemy crowd
+	void SetPatrolPoints(const FVector& WorldPatrolPoint, const FVector& WorldPatrolPoint2);
+
+	// Makes Target the Enemy's blackboard target
+	void SetTarget(AActor* Target);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	void SetComponentOverlaps();
 
 	void SetCollisionResponses();
 
 	void StartPatrol();
 
+	// Writes the patrol points, relative to the Enemy's current transform, to the blackboard
+	void SetPatrolPointKeys();
+
 	UFUNCTION(BlueprintNativeEvent)
 	void ShowHealthBar();
 	void ShowHealthBar_Implementation();
 
-	UFUNCTION(BlueprintImplementableEvent)
-	void HideHealthBar();
-
 	void Die();
 
 	void PlayHitMontage(FName Section, float PlayRate = 1.0f);
 
 	void ResetHitReactTimer();
 
+	// Hands a hit number widget created in Blueprints to the combat UI manager
 	UFUNCTION(BlueprintCallable)
 	void StoreHitNumber(UUserWidget* HitNumber, FVector Location);
 
-	UFUNCTION()
-	void DestroyHitNumber(UUserWidget* HitNumber);
-
-	void UpdateHitNumbers();
-
 	// Called when Shooter Character overlaps with the AgroSphere
 	UFUNCTION()
 	void AgroSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
@@ -121,6 +144,9 @@ protected:
 	UFUNCTION()
 	void DestroyEnemy();
 
+	// Asks the significance manager to re-score the Enemy now, e.g. on entering combat
+	void UpdateSignificance();
+
 private:
 	/* Particles to spawn when hit by bullets */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -138,15 +164,32 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float MaxHealth;
 
-	/* Name of the head bone */
+	/* Name of the head bone, used for head shots when no HitZones asset is set */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	FString HeadBone;
+	FName HeadBone;
+
+	/* Bones mapped to hit zones and damage multipliers */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	UHitZoneDataAsset* HitZones;
+
+	/* HitZones compiled for this Enemy's mesh at BeginPlay */
+	TSharedPtr<const FCompiledHitZones> CompiledHitZones;
+
+	/* Zone hit by the last bullet that damaged the Enemy */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	EHitZone LastHitZone;
 
 	/* Time to display health bar once shot */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float HealthBarDisplayTime;
 
-	FTimerHandle HealthBarTimer;
+	/* Pooled health bar widget drawn by the combat UI manager, leave empty to keep the Blueprint health bar */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<UEnemyHealthBarWidget> HealthBarWidgetClass;
+
+	/* Offset from the Enemy's location where the pooled health bar is drawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FVector HealthBarOffset;
 
 	/* Montage containing Hit and Death animations */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -158,9 +201,9 @@ private:
 
 	bool bCanHitReact;
 
-	/* Map to store HitNumber widgets and their hit locations*/
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "True"))
-	TMap<UUserWidget*, FVector> HitNumbers;
+	/* Pooled hit number widget shown by the combat UI manager */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<UHitNumberWidget> HitNumberWidgetClass;
 
 	/* Time before a HitNumber is removed from the screen */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -247,8 +290,26 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float DeathTime;
 
+	/* World time the Enemy last took damage */
+	float LastDamageTime;
+
+	/* Time after taking damage that the Enemy still counts as in combat */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CombatMemoryTime;
+
+	/* A blackboard target farther than this doesn't keep the Enemy in combat */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CombatDistance;
+
+	/* Handle of the enemy crowd agent this Enemy stands in for, INDEX_NONE when it is not part of the crowd */
+	int32 CrowdAgentHandle;
+
 public:	
 	// Getters for private variables
-	FORCEINLINE FString GetHeadBone() const { return HeadBone; }
+	FORCEINLINE FName GetHeadBone() const { return HeadBone; }
 	FORCEINLINE UBehaviorTree* GetBehaviorTree() const { return BehaviorTree; }
+	FORCEINLINE float GetHealth() const { return Health; }
+	FORCEINLINE void SetHealth(float NewHealth) { Health = FMath::Clamp(NewHealth, 0.f, MaxHealth); }
+	FORCEINLINE int32 GetCrowdAgentHandle() const { return CrowdAgentHandle; }
+	FORCEINLINE void SetCrowdAgentHandle(int32 Handle) { CrowdAgentHandle = Handle; }
 };
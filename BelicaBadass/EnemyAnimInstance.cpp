@@ -4,19 +4,31 @@
 #include "EnemyAnimInstance.h"
 #include "Enemy.h"
 
-UEnemyAnimInstance::UEnemyAnimInstance()
+UEnemyAnimInstance::UEnemyAnimInstance() :
+	EnemyVelocity(FVector::ZeroVector),
+	Speed(0.f)
 {
 }
 
 void UEnemyAnimInstance::UpdateAnimationProperties(float DeltaTime)
 {
+}
+
+void UEnemyAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeUpdateAnimation(DeltaSeconds);
+
 	if (Enemy == nullptr) Enemy = Cast<AEnemy>(TryGetPawnOwner());
 
-	if (Enemy)
-	{
-		// Get the lateral speed of the Enemy
-		FVector Velocity{ Enemy->GetVelocity() };
-		Velocity.Z = 0.f;
-		Speed = Velocity.Size();
-	}
+	EnemyVelocity = Enemy ? Enemy->GetVelocity() : FVector::ZeroVector;
+}
+
+void UEnemyAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	// Get the lateral speed of the Enemy
+	FVector Velocity{ EnemyVelocity };
+	Velocity.Z = 0.f;
+	Speed = Velocity.Size();
 }
@@ -16,10 +16,20 @@ class BELICABADASS_API UEnemyAnimInstance : public UAnimInstance
 public:
 	UEnemyAnimInstance();
 
-	UFUNCTION(BlueprintCallable)
+	// No longer does any work, the update runs in NativeThreadSafeUpdateAnimation; kept so existing graphs still compile
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Animation properties are now updated natively, remove this call from the event graph."))
 	void UpdateAnimationProperties(float DeltaTime);
 
+	// Copies the Enemy's velocity on the game thread
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+
+	// Computes Speed from the copied velocity on a worker thread
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
 private:
+	/* Velocity of the Enemy this frame, copied on the game thread */
+	FVector EnemyVelocity;
+
 	/* Lateral movement speed */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
 	float Speed;
@@ -0,0 +1,279 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyCrowdSubsystem.h"
+#include "Enemy.h"
+#include "EnemyPoolSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
+#include "BelicaBadass.h"
+
+static TAutoConsoleVariable<float> CVarCrowdPromoteDistance(
+	TEXT("Belica.Crowd.PromoteDistance"),
+	5000.f,
+	TEXT("Far-field enemies closer than this to the player are promoted to full enemy actors."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCrowdDemoteDistance(
+	TEXT("Belica.Crowd.DemoteDistance"),
+	6500.f,
+	TEXT("Promoted enemies out of combat and farther than this go back to the far-field simulation. Keep it above the promote distance."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCrowdMaxTransitionsPerFrame(
+	TEXT("Belica.Crowd.MaxTransitionsPerFrame"),
+	4,
+	TEXT("Most promotions plus demotions done in a single frame."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Crowd Simulate"), STAT_EnemyCrowdSimulate, STATGROUP_BelicaBadass);
+DECLARE_CYCLE_STAT(TEXT("Enemy Crowd Transitions"), STAT_EnemyCrowdTransitions, STATGROUP_BelicaBadass);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Crowd Agents"), STAT_EnemyCrowdAgents, STATGROUP_BelicaBadass);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Crowd Promoted"), STAT_EnemyCrowdPromoted, STATGROUP_BelicaBadass);
+
+namespace EnemyCrowd
+{
+	constexpr uint8 None{ 0 };
+	constexpr uint8 Promote{ 1 };
+	constexpr uint8 Demote{ 2 };
+
+	/* Distance at which a patrolling agent turns around */
+	constexpr float PatrolAcceptanceRadius{ 50.f };
+}
+
+UEnemyCrowdSubsystem::UEnemyCrowdSubsystem() :
+	NumAgents(0),
+	NumPromoted(0)
+{
+}
+
+void UEnemyCrowdSubsystem::Tick(float DeltaTime)
+{
+	if (NumAgents == 0) return;
+
+	FVector PlayerLocation;
+	if (!GetPlayerLocation(PlayerLocation)) return;
+
+	SimulateFarField(DeltaTime, PlayerLocation);
+
+	SCOPE_CYCLE_COUNTER(STAT_EnemyCrowdTransitions);
+
+	int32 TransitionsLeft{ FMath::Max(CVarCrowdMaxTransitionsPerFrame.GetValueOnGameThread(), 1) };
+	for (int32 i = 0; i < Transitions.Num() && TransitionsLeft > 0; i++)
+	{
+		if (Transitions[i] == EnemyCrowd::Promote) PromoteAgent(i);
+		else if (Transitions[i] == EnemyCrowd::Demote) DemoteAgent(i);
+		else continue;
+
+		TransitionsLeft--;
+	}
+}
+
+TStatId UEnemyCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyCrowdSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyCrowdSubsystem::Deinitialize()
+{
+	SET_DWORD_STAT(STAT_EnemyCrowdAgents, 0);
+	SET_DWORD_STAT(STAT_EnemyCrowdPromoted, 0);
+
+	Super::Deinitialize();
+}
+
+int32 UEnemyCrowdSubsystem::AddAgent(TSubclassOf<AEnemy> EnemyClass, FVector Location, FVector PatrolPointA, FVector PatrolPointB, float Health, float Speed, bool bHuntPlayer)
+{
+	if (EnemyClass == nullptr) return INDEX_NONE;
+
+	int32 Handle{ INDEX_NONE };
+	if (FreeHandles.Num() > 0) Handle = FreeHandles.Pop(false);
+	else
+	{
+		Handle = Positions.AddUninitialized();
+		Velocities.AddUninitialized();
+		PatrolPointsA.AddUninitialized();
+		PatrolPointsB.AddUninitialized();
+		Healths.AddUninitialized();
+		Speeds.AddUninitialized();
+		PatrolLegs.AddUninitialized();
+		bHunting.AddUninitialized();
+		bAlive.AddUninitialized();
+		Transitions.AddUninitialized();
+		AgentClasses.AddUninitialized();
+		PromotedEnemies.AddUninitialized();
+	}
+
+	Positions[Handle] = Location;
+	Velocities[Handle] = FVector::ZeroVector;
+	PatrolPointsA[Handle] = PatrolPointA;
+	PatrolPointsB[Handle] = PatrolPointB;
+	Healths[Handle] = Health;
+	Speeds[Handle] = Speed;
+	PatrolLegs[Handle] = 0;
+	bHunting[Handle] = bHuntPlayer;
+	bAlive[Handle] = true;
+	Transitions[Handle] = EnemyCrowd::None;
+	AgentClasses[Handle] = EnemyClass;
+	PromotedEnemies[Handle] = nullptr;
+
+	NumAgents++;
+	INC_DWORD_STAT(STAT_EnemyCrowdAgents);
+
+	return Handle;
+}
+
+void UEnemyCrowdSubsystem::RemoveAgent(int32 Handle)
+{
+	if (!bAlive.IsValidIndex(Handle) || !bAlive[Handle]) return;
+
+	if (AEnemy* Enemy{ PromotedEnemies[Handle] })
+	{
+		Enemy->SetCrowdAgentHandle(INDEX_NONE);
+
+		UEnemyPoolSubsystem* EnemyPool{ GetWorld()->GetSubsystem<UEnemyPoolSubsystem>() };
+		if (EnemyPool) EnemyPool->ReleaseEnemy(Enemy);
+		else Enemy->Destroy();
+	}
+
+	OnAgentKilled(Handle);
+}
+
+void UEnemyCrowdSubsystem::OnAgentKilled(int32 Handle)
+{
+	if (!bAlive.IsValidIndex(Handle) || !bAlive[Handle]) return;
+
+	if (PromotedEnemies[Handle])
+	{
+		PromotedEnemies[Handle] = nullptr;
+		NumPromoted--;
+		DEC_DWORD_STAT(STAT_EnemyCrowdPromoted);
+	}
+
+	bAlive[Handle] = false;
+	Transitions[Handle] = EnemyCrowd::None;
+	AgentClasses[Handle] = nullptr;
+	FreeHandles.Add(Handle);
+
+	NumAgents--;
+	DEC_DWORD_STAT(STAT_EnemyCrowdAgents);
+}
+
+void UEnemyCrowdSubsystem::SimulateFarField(float DeltaTime, const FVector& PlayerLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyCrowdSimulate);
+
+	const float PromoteDistanceSquared{ FMath::Square(CVarCrowdPromoteDistance.GetValueOnGameThread()) };
+	const float DemoteDistanceSquared{ FMath::Square(FMath::Max(CVarCrowdDemoteDistance.GetValueOnGameThread(), CVarCrowdPromoteDistance.GetValueOnGameThread())) };
+
+	// Promoted agents follow their Enemy; copy its location here so the parallel pass never touches actors
+	for (int32 i = 0; i < PromotedEnemies.Num(); i++)
+	{
+		const AEnemy* Enemy{ PromotedEnemies[i] };
+		if (Enemy == nullptr) continue;
+
+		Positions[i] = Enemy->GetActorLocation();
+		Transitions[i] = Enemy->IsInCombat() ? EnemyCrowd::None : EnemyCrowd::Demote;
+	}
+
+	ParallelFor(Positions.Num(), [&](int32 i)
+	{
+		if (!bAlive[i]) return;
+
+		const float DistanceSquared{ static_cast<float>(FVector::DistSquared(Positions[i], PlayerLocation)) };
+
+		// Promoted agents only need to know whether they have gone far enough to demote
+		if (Transitions[i] == EnemyCrowd::Demote || PromotedEnemies[i])
+		{
+			if (Transitions[i] == EnemyCrowd::Demote && DistanceSquared <= DemoteDistanceSquared) Transitions[i] = EnemyCrowd::None;
+			return;
+		}
+
+		FVector Destination{ bHunting[i] ? PlayerLocation : (PatrolLegs[i] == 0 ? PatrolPointsA[i] : PatrolPointsB[i]) };
+		FVector ToDestination{ Destination - Positions[i] };
+		ToDestination.Z = 0.f;
+
+		if (!bHunting[i] && ToDestination.SizeSquared() <= FMath::Square(EnemyCrowd::PatrolAcceptanceRadius))
+		{
+			PatrolLegs[i] ^= 1;
+			Destination = PatrolLegs[i] == 0 ? PatrolPointsA[i] : PatrolPointsB[i];
+			ToDestination = Destination - Positions[i];
+			ToDestination.Z = 0.f;
+		}
+
+		const float Distance{ static_cast<float>(ToDestination.Size()) };
+		const float Step{ FMath::Min(Speeds[i] * DeltaTime, Distance) };
+		Velocities[i] = Distance > KINDA_SMALL_NUMBER ? ToDestination / Distance * Speeds[i] : FVector::ZeroVector;
+		if (Distance > KINDA_SMALL_NUMBER) Positions[i] += ToDestination / Distance * Step;
+
+		Transitions[i] = DistanceSquared <= PromoteDistanceSquared ? EnemyCrowd::Promote : EnemyCrowd::None;
+	});
+}
+
+void UEnemyCrowdSubsystem::PromoteAgent(int32 Index)
+{
+	Transitions[Index] = EnemyCrowd::None;
+
+	UEnemyPoolSubsystem* EnemyPool{ GetWorld()->GetSubsystem<UEnemyPoolSubsystem>() };
+	if (EnemyPool == nullptr) return;
+
+	const FRotator Facing{ Velocities[Index].IsNearlyZero() ? FRotator::ZeroRotator : Velocities[Index].Rotation() };
+	AEnemy* Enemy{ EnemyPool->SpawnEnemy(AgentClasses[Index], FTransform(FRotator(0.f, Facing.Yaw, 0.f), Positions[Index])) };
+	if (Enemy == nullptr) return;
+
+	Enemy->SetCrowdAgentHandle(Index);
+	Enemy->SetHealth(Healths[Index]);
+	Enemy->SetPatrolPoints(PatrolPointsA[Index], PatrolPointsB[Index]);
+
+	if (bHunting[Index])
+	{
+		APlayerController* PlayerController{ GetWorld()->GetFirstPlayerController() };
+		if (PlayerController && PlayerController->GetPawn()) Enemy->SetTarget(PlayerController->GetPawn());
+	}
+
+	PromotedEnemies[Index] = Enemy;
+	NumPromoted++;
+	INC_DWORD_STAT(STAT_EnemyCrowdPromoted);
+}
+
+void UEnemyCrowdSubsystem::DemoteAgent(int32 Index)
+{
+	Transitions[Index] = EnemyCrowd::None;
+
+	AEnemy* Enemy{ PromotedEnemies[Index] };
+	if (Enemy == nullptr) return;
+
+	Positions[Index] = Enemy->GetActorLocation();
+	Velocities[Index] = Enemy->GetVelocity();
+	Healths[Index] = Enemy->GetHealth();
+
+	Enemy->SetCrowdAgentHandle(INDEX_NONE);
+	PromotedEnemies[Index] = nullptr;
+	NumPromoted--;
+	DEC_DWORD_STAT(STAT_EnemyCrowdPromoted);
+
+	UEnemyPoolSubsystem* EnemyPool{ GetWorld()->GetSubsystem<UEnemyPoolSubsystem>() };
+	if (EnemyPool) EnemyPool->ReleaseEnemy(Enemy);
+	else Enemy->Destroy();
+}
+
+bool UEnemyCrowdSubsystem::GetPlayerLocation(FVector& OutLocation) const
+{
+	APlayerController* PlayerController{ GetWorld()->GetFirstPlayerController() };
+	if (PlayerController == nullptr) return false;
+
+	if (APawn* Pawn{ PlayerController->GetPawn() })
+	{
+		OutLocation = Pawn->GetActorLocation();
+		return true;
+	}
+
+	if (PlayerController->PlayerCameraManager)
+	{
+		OutLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyCrowdSubsystem.generated.h"
+
+class AEnemy;
+
+/**
+ * Simulates distant enemies as plain arrays instead of actors. Each frame the far-field agents patrol
+ * or hunt the player in a ParallelFor; agents that come close are promoted to pooled AEnemy actors and
+ * demoted back once they are far away and out of combat, carrying their patrol points and health across.
+ */
+UCLASS()
+class BELICABADASS_API UEnemyCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyCrowdSubsystem();
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual void Deinitialize() override;
+
+	// Adds a far-field enemy patrolling between two world points and returns its handle
+	UFUNCTION(BlueprintCallable, Category = "Enemy Crowd")
+	int32 AddAgent(TSubclassOf<AEnemy> EnemyClass, FVector Location, FVector PatrolPointA, FVector PatrolPointB, float Health = 100.f, float Speed = 300.f, bool bHuntPlayer = false);
+
+	// Removes an agent, releasing its Enemy if it is promoted
+	UFUNCTION(BlueprintCallable, Category = "Enemy Crowd")
+	void RemoveAgent(int32 Handle);
+
+	// Called by a promoted Enemy when it dies so the agent is not demoted or promoted again
+	void OnAgentKilled(int32 Handle);
+
+	UFUNCTION(BlueprintPure, Category = "Enemy Crowd")
+	int32 GetNumAgents() const { return NumAgents; }
+
+	UFUNCTION(BlueprintPure, Category = "Enemy Crowd")
+	int32 GetNumPromoted() const { return NumPromoted; }
+
+protected:
+	// Moves every far-field agent and flags the ones that should change representation
+	void SimulateFarField(float DeltaTime, const FVector& PlayerLocation);
+
+	void PromoteAgent(int32 Index);
+
+	void DemoteAgent(int32 Index);
+
+	bool GetPlayerLocation(FVector& OutLocation) const;
+
+private:
+	/* Agent data, one entry per handle, read and written in parallel by SimulateFarField */
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<FVector> PatrolPointsA;
+	TArray<FVector> PatrolPointsB;
+	TArray<float> Healths;
+	TArray<float> Speeds;
+	TArray<uint8> PatrolLegs;
+	TArray<uint8> bHunting;
+	TArray<uint8> bAlive;
+
+	/* Written by SimulateFarField: 1 to promote, 2 to demote */
+	TArray<uint8> Transitions;
+
+	/* Class each agent spawns as when promoted */
+	UPROPERTY()
+	TArray<UClass*> AgentClasses;
+
+	/* Enemy standing in for each agent while promoted */
+	UPROPERTY()
+	TArray<AEnemy*> PromotedEnemies;
+
+	/* Handles of removed agents, reused by AddAgent */
+	TArray<int32> FreeHandles;
+
+	int32 NumAgents;
+
+	int32 NumPromoted;
+};
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "EnemyHealthBarWidget.generated.h"
+
+/**
+ * Health bar drawn over a damaged Enemy; instances are pooled by UCombatUISubsystem
+ */
+UCLASS()
+class BELICABADASS_API UEnemyHealthBarWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	// Called when the bar is handed out and whenever its Enemy takes damage
+	UFUNCTION(BlueprintImplementableEvent)
+	void SetHealthPercent(float HealthPercent);
+};
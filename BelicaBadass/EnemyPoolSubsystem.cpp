@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyPoolSubsystem.h"
+#include "Enemy.h"
+#include "HAL/IConsoleManager.h"
+#include "BelicaBadass.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Enemies Reused"), STAT_PooledEnemiesReused, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Enemies Created"), STAT_PooledEnemiesCreated, STATGROUP_BelicaBadass);
+
+static FAutoConsoleCommandWithWorld DumpEnemyPoolsCommand(
+	TEXT("Belica.EnemyPool.Dump"),
+	TEXT("Logs active, free and high-water counts of the pooled enemies."),
+	ObjectPool::MakeDumpCommand<UEnemyPoolSubsystem>());
+
+UEnemyPoolSubsystem::UEnemyPoolSubsystem() :
+	MaxFreePerClass(64)
+{
+}
+
+void UEnemyPoolSubsystem::Deinitialize()
+{
+	Pools.Empty();
+	ActiveEnemies.Empty();
+
+	Super::Deinitialize();
+}
+
+void UEnemyPoolSubsystem::Prewarm(TSubclassOf<AEnemy> EnemyClass, int32 Count)
+{
+	if (EnemyClass == nullptr) return;
+
+	FObjectPool& Pool{ Pools.FindOrAdd(EnemyClass) };
+	while (Pool.FreeObjects.Num() < FMath::Min(Count, MaxFreePerClass))
+	{
+		AEnemy* Enemy{ CreatePooledEnemy(EnemyClass, FTransform::Identity) };
+		if (Enemy == nullptr) return;
+
+		Enemy->Deactivate();
+		Pool.AddFree(Enemy, MaxFreePerClass);
+	}
+}
+
+AEnemy* UEnemyPoolSubsystem::SpawnEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& SpawnTransform)
+{
+	if (EnemyClass == nullptr) return nullptr;
+
+	FObjectPool& Pool{ Pools.FindOrAdd(EnemyClass) };
+	AEnemy* Enemy{ Pool.PopFree<AEnemy>() };
+
+	if (Enemy)
+	{
+		Enemy->ResetForSpawn(SpawnTransform);
+		INC_DWORD_STAT(STAT_PooledEnemiesReused);
+	}
+	else
+	{
+		Enemy = CreatePooledEnemy(EnemyClass, SpawnTransform);
+		if (Enemy == nullptr) return nullptr;
+	}
+
+	Pool.MarkAcquired();
+	ActiveEnemies.Add(Enemy);
+
+	return Enemy;
+}
+
+void UEnemyPoolSubsystem::ReleaseEnemy(AEnemy* Enemy)
+{
+	if (!IsValid(Enemy)) return;
+
+	FObjectPool& Pool{ Pools.FindOrAdd(Enemy->GetClass()) };
+
+	// Level-placed enemies join the pool here without ever having been handed out
+	if (ActiveEnemies.Remove(Enemy) > 0) Pool.MarkReleased();
+
+	if (!Pool.AddFree(Enemy, MaxFreePerClass))
+	{
+		Enemy->Destroy();
+		return;
+	}
+
+	Enemy->Deactivate();
+}
+
+void UEnemyPoolSubsystem::DumpPoolStats() const
+{
+	ObjectPool::DumpPoolStats(TEXT("Enemy"), Pools);
+}
+
+AEnemy* UEnemyPoolSubsystem::CreatePooledEnemy(UClass* EnemyClass, const FTransform& SpawnTransform)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	AEnemy* Enemy{ GetWorld()->SpawnActor<AEnemy>(EnemyClass, SpawnTransform, SpawnParams) };
+	if (Enemy == nullptr) return nullptr;
+
+	// Blueprints that only auto possess when placed in the world still need a controller to patrol
+	if (Enemy->GetController() == nullptr)
+	{
+		Enemy->SpawnDefaultController();
+		Enemy->ResetForSpawn(SpawnTransform);
+	}
+
+	INC_DWORD_STAT(STAT_PooledEnemiesCreated);
+
+	return Enemy;
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ObjectPool.h"
+#include "EnemyPoolSubsystem.generated.h"
+
+class AEnemy;
+
+/**
+ * Keeps dead enemies around deactivated and resets them when a new one is needed, so a wave
+ * doesn't pay for actor spawning, component registration and behavior tree setup per enemy.
+ */
+UCLASS()
+class BELICABADASS_API UEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyPoolSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// Spawns deactivated enemies of EnemyClass until Count of them are free in its pool
+	UFUNCTION(BlueprintCallable, Category = "Enemy Pool")
+	void Prewarm(TSubclassOf<AEnemy> EnemyClass, int32 Count);
+
+	// Places an Enemy of EnemyClass at SpawnTransform, reusing a pooled one when there is one
+	UFUNCTION(BlueprintCallable, Category = "Enemy Pool")
+	AEnemy* SpawnEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& SpawnTransform);
+
+	// Deactivates Enemy and keeps it for the next spawn of its class
+	UFUNCTION(BlueprintCallable, Category = "Enemy Pool")
+	void ReleaseEnemy(AEnemy* Enemy);
+
+	// Logs active, free and high-water counts for every enemy class
+	void DumpPoolStats() const;
+
+protected:
+	AEnemy* CreatePooledEnemy(UClass* EnemyClass, const FTransform& SpawnTransform);
+
+private:
+	/* Pool of enemies for each enemy class */
+	UPROPERTY()
+	TMap<UClass*, FObjectPool> Pools;
+
+	/* Enemies handed out by SpawnEnemy, only these count against a pool's active enemies when released */
+	TSet<TWeakObjectPtr<AEnemy>> ActiveEnemies;
+
+	/* Released enemies beyond this count are destroyed instead of pooled */
+	int32 MaxFreePerClass;
+};
@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySignificanceSubsystem.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "BrainComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
+#include "IAnimationBudgetAllocator.h"
+#include "AnimationBudgetAllocatorParameters.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "BelicaBadass.h"
+
+static TAutoConsoleVariable<int32> CVarSignificanceEnemiesPerFrame(
+	TEXT("Belica.Significance.EnemiesPerFrame"),
+	16,
+	TEXT("Number of enemies re-scored by the significance manager each frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceNearDistance(
+	TEXT("Belica.Significance.NearDistance"),
+	1500.f,
+	TEXT("Enemies closer than this to the player always update at full rate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceFarDistance(
+	TEXT("Belica.Significance.FarDistance"),
+	4000.f,
+	TEXT("Visible enemies closer than this update at medium rate, hidden ones at low rate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceDormantDistance(
+	TEXT("Belica.Significance.DormantDistance"),
+	8000.f,
+	TEXT("Hidden enemies farther than this, and every enemy beyond twice this, go dormant."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyAnimBudgetMs(
+	TEXT("Belica.EnemyAnimBudgetMs"),
+	1.5f,
+	TEXT("Game thread time in milliseconds the animation budget allocator may spend on enemy meshes each frame. 0 turns the budget off."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Significance Tick"), STAT_EnemySignificanceTick, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Bucket Changes"), STAT_EnemyBucketChanges, STATGROUP_BelicaBadass);
+
+void UEnemySignificanceSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemySignificanceTick);
+
+	UpdateAnimBudget();
+
+	if (Enemies.Num() == 0) return;
+
+	FVector PlayerLocation;
+	if (!GetPlayerLocation(PlayerLocation)) return;
+
+	// Re-score a slice of the enemies, wrapping around the list
+	const int32 Count{ FMath::Min(FMath::Max(CVarSignificanceEnemiesPerFrame.GetValueOnGameThread(), 1), Enemies.Num()) };
+	for (int32 i = 0; i < Count; i++)
+	{
+		if (NextEnemyIndex >= Enemies.Num()) NextEnemyIndex = 0;
+
+		AEnemy* Enemy{ Enemies[NextEnemyIndex] };
+		if (IsValid(Enemy))
+		{
+			const ESignificanceBucket Bucket{ ComputeBucket(Enemy, PlayerLocation) };
+			if (Bucket != Buckets[NextEnemyIndex])
+			{
+				Buckets[NextEnemyIndex] = Bucket;
+				ApplyBucket(Enemy, Bucket);
+			}
+			NextEnemyIndex++;
+		}
+		else
+		{
+			Enemies.RemoveAtSwap(NextEnemyIndex, 1, false);
+			Buckets.RemoveAtSwap(NextEnemyIndex, 1, false);
+			if (Enemies.Num() == 0) return;
+		}
+	}
+}
+
+TStatId UEnemySignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemySignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemySignificanceSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || Enemies.Contains(Enemy)) return;
+
+	// Start at full rate so a freshly spawned Enemy never misses its first frames
+	Enemies.Add(Enemy);
+	Buckets.Add(ESignificanceBucket::ESB_High);
+	ApplyBucket(Enemy, ESignificanceBucket::ESB_High);
+}
+
+void UEnemySignificanceSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	const int32 Index{ Enemies.Find(Enemy) };
+	if (Index == INDEX_NONE) return;
+
+	Enemies.RemoveAtSwap(Index, 1, false);
+	Buckets.RemoveAtSwap(Index, 1, false);
+}
+
+void UEnemySignificanceSubsystem::UpdateEnemy(AEnemy* Enemy)
+{
+	const int32 Index{ Enemies.Find(Enemy) };
+	if (Index == INDEX_NONE) return;
+
+	FVector PlayerLocation;
+	if (!GetPlayerLocation(PlayerLocation)) return;
+
+	const ESignificanceBucket Bucket{ ComputeBucket(Enemy, PlayerLocation) };
+	if (Bucket != Buckets[Index])
+	{
+		Buckets[Index] = Bucket;
+		ApplyBucket(Enemy, Bucket);
+	}
+}
+
+const FSignificanceBucketSettings& UEnemySignificanceSubsystem::GetBucketSettings(ESignificanceBucket Bucket)
+{
+	static const FSignificanceBucketSettings Settings[] =
+	{
+		{ 0.f, 0.f, 0.f, true, 1.f },			// High
+		{ 0.033f, 0.033f, 0.1f, true, 0.6f },	// Medium
+		{ 0.1f, 0.1f, 0.25f, false, 0.3f },		// Low
+		{ 0.5f, 0.5f, 1.f, false, 0.1f }		// Dormant
+	};
+	static_assert(UE_ARRAY_COUNT(Settings) == static_cast<int32>(ESignificanceBucket::ESB_MAX), "Every significance bucket needs settings");
+
+	return Settings[FMath::Min(static_cast<int32>(Bucket), static_cast<int32>(ESignificanceBucket::ESB_Dormant))];
+}
+
+ESignificanceBucket UEnemySignificanceSubsystem::ComputeBucket(const AEnemy* Enemy, const FVector& PlayerLocation) const
+{
+	// Anything fighting the player runs at full rate wherever it is
+	if (Enemy->IsInCombat()) return ESignificanceBucket::ESB_High;
+
+	const float DistanceSquared{ static_cast<float>(FVector::DistSquared(Enemy->GetActorLocation(), PlayerLocation)) };
+	const float NearDistance{ CVarSignificanceNearDistance.GetValueOnGameThread() };
+	const float FarDistance{ CVarSignificanceFarDistance.GetValueOnGameThread() };
+	const float DormantDistance{ CVarSignificanceDormantDistance.GetValueOnGameThread() };
+
+	if (DistanceSquared <= FMath::Square(NearDistance)) return ESignificanceBucket::ESB_High;
+
+	const bool bVisible{ Enemy->WasRecentlyRendered(0.2f) };
+	if (DistanceSquared <= FMath::Square(FarDistance)) return bVisible ? ESignificanceBucket::ESB_Medium : ESignificanceBucket::ESB_Low;
+	if (DistanceSquared <= FMath::Square(DormantDistance)) return bVisible ? ESignificanceBucket::ESB_Low : ESignificanceBucket::ESB_Dormant;
+	if (bVisible && DistanceSquared <= FMath::Square(DormantDistance * 2.f)) return ESignificanceBucket::ESB_Low;
+
+	return ESignificanceBucket::ESB_Dormant;
+}
+
+void UEnemySignificanceSubsystem::ApplyBucket(AEnemy* Enemy, ESignificanceBucket Bucket)
+{
+	INC_DWORD_STAT(STAT_EnemyBucketChanges);
+
+	const FSignificanceBucketSettings& Settings{ GetBucketSettings(Bucket) };
+
+	Enemy->SetActorTickInterval(Settings.TickInterval);
+
+	if (UCharacterMovementComponent* Movement{ Enemy->GetCharacterMovement() }) Movement->SetComponentTickInterval(Settings.TickInterval);
+
+	if (USkeletalMeshComponent* Mesh{ Enemy->GetMesh() })
+	{
+		Mesh->VisibilityBasedAnimTickOption = Settings.bTickPoseWhenNotRendered ?
+			EVisibilityBasedAnimTickOption::AlwaysTickPose :
+			EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+
+		// The budget allocator owns the tick rate of meshes registered with it
+		USkeletalMeshComponentBudgeted* BudgetedMesh{ Cast<USkeletalMeshComponentBudgeted>(Mesh) };
+		if (bAnimBudgetEnabled && BudgetedMesh)
+		{
+			Mesh->SetComponentTickInterval(0.f);
+			BudgetedMesh->SetComponentSignificance(Settings.AnimBudgetSignificance, false, Settings.bTickPoseWhenNotRendered);
+		}
+		else Mesh->SetComponentTickInterval(Settings.AnimTickInterval);
+	}
+
+	// RunBehaviorTree may create its own component, so go through the brain that is actually running
+	AEnemyController* EnemyController{ Cast<AEnemyController>(Enemy->GetController()) };
+	UBrainComponent* Brain{ EnemyController ? EnemyController->GetBrainComponent() : nullptr };
+	if (Brain) Brain->SetComponentTickInterval(Settings.BehaviorTreeTickInterval);
+}
+
+bool UEnemySignificanceSubsystem::GetPlayerLocation(FVector& OutLocation) const
+{
+	APlayerController* PlayerController{ GetWorld()->GetFirstPlayerController() };
+	if (PlayerController == nullptr) return false;
+
+	if (PlayerController->PlayerCameraManager)
+	{
+		OutLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		return true;
+	}
+
+	if (APawn* Pawn{ PlayerController->GetPawn() })
+	{
+		OutLocation = Pawn->GetActorLocation();
+		return true;
+	}
+
+	return false;
+}
+
+void UEnemySignificanceSubsystem::UpdateAnimBudget()
+{
+	const float BudgetMs{ CVarEnemyAnimBudgetMs.GetValueOnGameThread() };
+	if (BudgetMs == AppliedAnimBudgetMs) return;
+
+	IAnimationBudgetAllocator* Allocator{ IAnimationBudgetAllocator::Get(GetWorld()) };
+	if (Allocator == nullptr) return;
+
+	AppliedAnimBudgetMs = BudgetMs;
+
+	const bool bWasEnabled{ bAnimBudgetEnabled };
+	bAnimBudgetEnabled = BudgetMs > 0.f;
+	Allocator->SetEnabled(bAnimBudgetEnabled);
+
+	if (bAnimBudgetEnabled)
+	{
+		FAnimationBudgetAllocatorParameters Parameters;
+		Parameters.BudgetInMs = BudgetMs;
+		Allocator->SetParameters(Parameters);
+	}
+
+	// Re-apply every bucket so meshes switch between the allocator and fixed tick intervals
+	if (bWasEnabled != bAnimBudgetEnabled)
+	{
+		for (int32 i = 0; i < Enemies.Num(); i++)
+		{
+			if (IsValid(Enemies[i])) ApplyBucket(Enemies[i], Buckets[i]);
+		}
+	}
+}
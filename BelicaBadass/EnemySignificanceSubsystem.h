@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemySignificanceSubsystem.generated.h"
+
+class AEnemy;
+
+UENUM(BlueprintType)
+enum class ESignificanceBucket : uint8
+{
+	ESB_High UMETA(DisplayName = "High"),
+	ESB_Medium UMETA(DisplayName = "Medium"),
+	ESB_Low UMETA(DisplayName = "Low"),
+	ESB_Dormant UMETA(DisplayName = "Dormant"),
+	ESB_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+/* Update rates applied to every Enemy in a significance bucket */
+struct FSignificanceBucketSettings
+{
+	/* Tick interval of the Enemy actor and its CharacterMovement */
+	float TickInterval;
+
+	/* Tick interval of the mesh, which drives the anim instance update */
+	float AnimTickInterval;
+
+	/* Tick interval of the Enemy's behavior tree */
+	float BehaviorTreeTickInterval;
+
+	/* True to keep the mesh updating its pose while off screen */
+	bool bTickPoseWhenNotRendered;
+
+	/* Significance handed to the animation budget allocator, which sets the mesh's update rate instead when it is enabled */
+	float AnimBudgetSignificance;
+};
+
+/**
+ * Scores every Enemy by distance to the player, visibility and combat state, and puts it into a bucket
+ * whose tick, movement, animation and behavior tree update rates are applied when its bucket changes.
+ * Enemies are re-scored a slice at a time so the cost of the manager stays flat as enemy counts grow.
+ */
+UCLASS()
+class BELICABADASS_API UEnemySignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	void RegisterEnemy(AEnemy* Enemy);
+
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	// Re-scores Enemy right away, e.g. when it enters combat
+	void UpdateEnemy(AEnemy* Enemy);
+
+	static const FSignificanceBucketSettings& GetBucketSettings(ESignificanceBucket Bucket);
+
+protected:
+	// Picks the bucket for Enemy given the player's location
+	ESignificanceBucket ComputeBucket(const AEnemy* Enemy, const FVector& PlayerLocation) const;
+
+	// Applies the update rates of Bucket to Enemy
+	void ApplyBucket(AEnemy* Enemy, ESignificanceBucket Bucket);
+
+	bool GetPlayerLocation(FVector& OutLocation) const;
+
+	// Pushes Belica.EnemyAnimBudgetMs to this world's animation budget allocator when it changes
+	void UpdateAnimBudget();
+
+private:
+	/* Every registered Enemy */
+	UPROPERTY()
+	TArray<AEnemy*> Enemies;
+
+	/* Bucket currently applied to the Enemy at the same index */
+	TArray<ESignificanceBucket> Buckets;
+
+	/* Index of the next Enemy to be re-scored */
+	int32 NextEnemyIndex{ 0 };
+
+	/* Animation budget last given to the allocator, negative until the first update */
+	float AppliedAnimBudgetMs{ -1.f };
+
+	/* True while the animation budget allocator drives the enemy meshes */
+	bool bAnimBudgetEnabled{ false };
+};
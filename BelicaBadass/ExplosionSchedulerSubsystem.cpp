@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ExplosionSchedulerSubsystem.h"
+#include "Explosive.h"
+#include "Kismet/GameplayStatics.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/IConsoleManager.h"
+#include "BelicaBadass.h"
+
+static TAutoConsoleVariable<float> CVarExplosionBudgetMs(
+	TEXT("Belica.Explosion.BudgetMs"),
+	0.5f,
+	TEXT("Game thread time in milliseconds the explosion scheduler may spend each frame. At least one explosive always goes off."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarExplosionChainDelay(
+	TEXT("Belica.Explosion.ChainDelay"),
+	0.1f,
+	TEXT("Seconds before an explosive caught in a blast goes off itself."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Explosion Scheduler Tick"), STAT_ExplosionSchedulerTick, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosives Detonated"), STAT_ExplosivesDetonated, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Victims Damaged"), STAT_ExplosionVictimsDamaged, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Line Of Sight Traces"), STAT_ExplosionTraces, STATGROUP_BelicaBadass);
+
+float FPendingBlast::GetDamageAt(float Distance) const
+{
+	if (Distance <= InnerRadius || OuterRadius <= InnerRadius) return Damage;
+
+	const float Alpha{ FMath::Clamp((Distance - InnerRadius) / (OuterRadius - InnerRadius), 0.f, 1.f) };
+	return FMath::Lerp(MinimumDamage, Damage, FMath::Pow(1.f - Alpha, DamageFalloff));
+}
+
+void UExplosionSchedulerSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ExplosionSchedulerTick);
+
+	ResolveBlasts();
+
+	if (Queue.Num() > 0)
+	{
+		DetonateReady();
+	}
+
+	ApplyFrameDamage();
+}
+
+void UExplosionSchedulerSubsystem::DetonateReady()
+{
+	const double Now{ GetWorld()->GetTimeSeconds() };
+	const double StartTime{ FPlatformTime::Seconds() };
+	const double Budget{ FMath::Max(CVarExplosionBudgetMs.GetValueOnGameThread(), 0.f) / 1000.0 };
+
+	// Chained detonations are inserted after everything already processed, so the processed prefix stays put
+	int32 Processed{ 0 };
+	while (Processed < Queue.Num() && Queue[Processed].ReadyTime <= Now)
+	{
+		if (Processed > 0 && FPlatformTime::Seconds() - StartTime > Budget) break;
+
+		const FPendingDetonation Detonation{ Queue[Processed] };
+		Detonate(Detonation);
+		Processed++;
+	}
+
+	if (Processed > 0) Queue.RemoveAt(0, Processed, false);
+}
+
+TStatId UExplosionSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UExplosionSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+void UExplosionSchedulerSubsystem::QueueDetonation(AExplosive* Explosive, AActor* Shooter, AController* ShooterController, float Delay)
+{
+	if (!IsValid(Explosive) || Explosive->IsDetonationQueued()) return;
+
+	Explosive->SetDetonationQueued(true);
+
+	FPendingDetonation Detonation;
+	Detonation.Explosive = Explosive;
+	Detonation.Shooter = Shooter;
+	Detonation.ShooterController = ShooterController;
+	Detonation.ReadyTime = GetWorld()->GetTimeSeconds() + Delay;
+
+	// Keep the queue sorted so the tick can stop at the first Explosive that isn't ready
+	const int32 Index{ Algo::UpperBoundBy(Queue, Detonation.ReadyTime, &FPendingDetonation::ReadyTime) };
+	Queue.Insert(Detonation, Index);
+}
+
+void UExplosionSchedulerSubsystem::Detonate(const FPendingDetonation& Detonation)
+{
+	AExplosive* Explosive{ Detonation.Explosive.Get() };
+	if (!IsValid(Explosive)) return;
+
+	FPendingBlast& Blast{ PendingBlasts.AddDefaulted_GetRef() };
+	Explosive->InitBlast(Blast);
+	Blast.Shooter = Detonation.Shooter;
+	Blast.ShooterController = Detonation.ShooterController;
+
+	TArray<AActor*> Targets;
+	Explosive->GatherBlastTargets(Targets);
+
+	// Only static geometry blocks a blast; the traces run with the rest of the world's async traces
+	FCollisionQueryParams TraceParams{ SCENE_QUERY_STAT(ExplosionLineOfSight), false, Explosive };
+	const FCollisionObjectQueryParams CoverParams{ ECC_WorldStatic };
+	for (AActor* Target : Targets)
+	{
+		FBlastTarget& BlastTarget{ Blast.Targets.AddDefaulted_GetRef() };
+		BlastTarget.Actor = Target;
+		BlastTarget.Distance = FVector::Dist(Blast.Origin, Target->GetActorLocation());
+		BlastTarget.TraceHandle = GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Single, Blast.Origin, Target->GetActorLocation(), CoverParams, TraceParams);
+		INC_DWORD_STAT(STAT_ExplosionTraces);
+	}
+
+	Explosive->Explode();
+	INC_DWORD_STAT(STAT_ExplosivesDetonated);
+}
+
+void UExplosionSchedulerSubsystem::ResolveBlasts()
+{
+	const float ChainDelay{ FMath::Max(CVarExplosionChainDelay.GetValueOnGameThread(), 0.f) };
+
+	for (int32 i = PendingBlasts.Num() - 1; i >= 0; i--)
+	{
+		FPendingBlast& Blast{ PendingBlasts[i] };
+		for (int32 j = Blast.Targets.Num() - 1; j >= 0; j--)
+		{
+			const FBlastTarget& Target{ Blast.Targets[j] };
+
+			// Results of last frame's traces are only available for one frame, a lost trace counts as visible
+			FTraceDatum TraceData;
+			const bool bTraceDone{ GetWorld()->QueryTraceData(Target.TraceHandle, TraceData) };
+			if (!bTraceDone && GetWorld()->IsTraceHandleValid(Target.TraceHandle, false)) continue;
+
+			const FHitResult* Cover{ bTraceDone ? FHitResult::GetFirstBlockingHit(TraceData.OutHits) : nullptr };
+			AActor* Actor{ Target.Actor.Get() };
+			if (IsValid(Actor) && (Cover == nullptr || Cover->GetActor() == Actor))
+			{
+				AExplosive* CaughtExplosive{ Cast<AExplosive>(Actor) };
+				if (CaughtExplosive)
+				{
+					QueueDetonation(CaughtExplosive, Blast.Shooter.Get(), Blast.ShooterController.Get(), ChainDelay);
+				}
+				else
+				{
+					const float Damage{ Blast.GetDamageAt(Target.Distance) };
+					FExplosionDamage* Existing{ FrameDamage.Find(Actor) };
+					if (Existing == nullptr || Existing->Damage < Damage) FrameDamage.Add(Actor, FExplosionDamage{ Damage, Blast.Shooter, Blast.ShooterController });
+				}
+			}
+
+			Blast.Targets.RemoveAtSwap(j, 1, false);
+		}
+
+		if (Blast.Targets.Num() == 0) PendingBlasts.RemoveAtSwap(i, 1, false);
+	}
+}
+
+void UExplosionSchedulerSubsystem::ApplyFrameDamage()
+{
+	for (const auto& DamagePair : FrameDamage)
+	{
+		AActor* Victim{ DamagePair.Key.Get() };
+		if (!IsValid(Victim)) continue;
+
+		const FExplosionDamage& ExplosionDamage{ DamagePair.Value };
+		UGameplayStatics::ApplyDamage(Victim, ExplosionDamage.Damage, ExplosionDamage.ShooterController.Get(), ExplosionDamage.Shooter.Get(), UDamageType::StaticClass());
+		INC_DWORD_STAT(STAT_ExplosionVictimsDamaged);
+	}
+
+	FrameDamage.Reset();
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ExplosionSchedulerSubsystem.generated.h"
+
+class AExplosive;
+
+/* An Explosive waiting for its turn to go off */
+struct FPendingDetonation
+{
+	TWeakObjectPtr<AExplosive> Explosive;
+
+	/* Who gets credit for the damage, carried down the whole chain */
+	TWeakObjectPtr<AActor> Shooter;
+	TWeakObjectPtr<AController> ShooterController;
+
+	/* World time at which the Explosive may go off */
+	double ReadyTime;
+};
+
+/* An Actor inside a blast radius whose line of sight to the blast is being traced */
+struct FBlastTarget
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	/* Distance from the blast origin */
+	float Distance;
+
+	FTraceHandle TraceHandle;
+};
+
+/* A detonation waiting on its line of sight traces before it deals damage */
+struct FPendingBlast
+{
+	FVector Origin;
+
+	/* Damage at InnerRadius or closer, falling off to MinimumDamage at OuterRadius */
+	float Damage;
+	float MinimumDamage;
+	float InnerRadius;
+	float OuterRadius;
+	float DamageFalloff;
+
+	TWeakObjectPtr<AActor> Shooter;
+	TWeakObjectPtr<AController> ShooterController;
+
+	TArray<FBlastTarget> Targets;
+
+	// Damage dealt at Distance from the Origin
+	float GetDamageAt(float Distance) const;
+};
+
+/* Damage one victim takes from this frame's detonations, only the strongest hit counts */
+struct FExplosionDamage
+{
+	float Damage;
+	TWeakObjectPtr<AActor> Shooter;
+	TWeakObjectPtr<AController> ShooterController;
+};
+
+/**
+ * Detonates queued Explosives in batches under a per-frame time budget, so a field of barrels
+ * going off spreads its overlap queries, FX and destroys across frames. Each detonation runs one
+ * broadphase query and batches line of sight checks as async traces; the next frame, visible
+ * targets take damage with distance falloff and visible Explosives are queued with a short delay.
+ * Each victim takes damage at most once per frame.
+ */
+UCLASS()
+class BELICABADASS_API UExplosionSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	// Queues Explosive to go off after Delay seconds, does nothing if it is already queued
+	void QueueDetonation(AExplosive* Explosive, AActor* Shooter, AController* ShooterController, float Delay = 0.f);
+
+protected:
+	// Detonates queued Explosives that are ready, until the frame's budget runs out
+	void DetonateReady();
+
+	// Detonates one Explosive and starts the line of sight traces to everything in its blast radius
+	void Detonate(const FPendingDetonation& Detonation);
+
+	// Turns blasts whose traces are done into FrameDamage and chained detonations
+	void ResolveBlasts();
+
+	// Applies the collected damage once per victim
+	void ApplyFrameDamage();
+
+private:
+	/* Explosives waiting to go off, in ReadyTime order */
+	TArray<FPendingDetonation> Queue;
+
+	/* Blasts waiting on their traces */
+	TArray<FPendingBlast> PendingBlasts;
+
+	/* Victims hit by this frame's blasts */
+	TMap<TWeakObjectPtr<AActor>, FExplosionDamage> FrameDamage;
+};
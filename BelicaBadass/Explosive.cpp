@@ -5,53 +5,87 @@
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
 #include "Particles/ParticleSystemComponent.h"
-#include "Components/SphereComponent.h"
 #include "GameFramework/Character.h"
-#include "Kismet/GameplayStatics.h"
+#include "FXPoolSubsystem.h"
+#include "ExplosionSchedulerSubsystem.h"
 
 // Sets default values
 AExplosive::AExplosive() :
-	Damage(100.f)
+	Damage(100.f),
+	MinimumDamage(20.f),
+	InnerBlastRadius(150.f),
+	BlastRadius(500.f),
+	DamageFalloff(1.f),
+	bDetonationQueued(false)
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	ExplosiveMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("ExplosiveMesh"));
 	SetRootComponent(ExplosiveMesh);
 
-	OverlapSphere = CreateDefaultSubobject<USphereComponent>(TEXT("OverlapSphere"));
-	OverlapSphere->SetupAttachment(GetRootComponent());
+	BlastObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_Pawn));
+	BlastObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_WorldDynamic));
+	BlastObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_PhysicsBody));
 }
 
-// Called when the game starts or when spawned
-void AExplosive::BeginPlay()
+void AExplosive::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController)
 {
-	Super::BeginPlay();
-	
-}
+	if (ImpactSound) UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
 
-// Called every frame
-void AExplosive::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+	// The scheduler spreads chains of Explosives across frames
+	UExplosionSchedulerSubsystem* Scheduler{ GetWorld()->GetSubsystem<UExplosionSchedulerSubsystem>() };
+	if (Scheduler)
+	{
+		Scheduler->QueueDetonation(this, Shooter, ShooterController);
+		return;
+	}
+
+	// Without a scheduler there is no line of sight check or chaining, only falloff
+	FPendingBlast Blast;
+	InitBlast(Blast);
+
+	TArray<AActor*> Targets;
+	GatherBlastTargets(Targets);
+	for (auto Target : Targets)
+	{
+		if (Target->IsA<AExplosive>()) continue;
+
+		const float TargetDamage{ Blast.GetDamageAt(FVector::Dist(Blast.Origin, Target->GetActorLocation())) };
+		UGameplayStatics::ApplyDamage(Target, TargetDamage, ShooterController, Shooter, UDamageType::StaticClass());
+	}
 
+	Explode();
 }
 
-void AExplosive::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController)
+void AExplosive::GatherBlastTargets(TArray<AActor*>& OutTargets) const
 {
-	if (ImpactSound) UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
+	const FCollisionObjectQueryParams ObjectParams{ BlastObjectTypes };
+	FCollisionQueryParams QueryParams{ SCENE_QUERY_STAT(ExplosiveBlast), false, this };
 
-	if (ExplodeParticles) UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplodeParticles, HitResult.Location, FRotator(0.f), true);
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByObjectType(Overlaps, GetActorLocation(), FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(BlastRadius), QueryParams);
 
-	TArray<AActor*> OverlappingActors;
-	GetOverlappingActors(OverlappingActors, ACharacter::StaticClass());
-
-	for (auto Actor : OverlappingActors)
+	// An Actor shows up once per overlapping component
+	for (const FOverlapResult& Overlap : Overlaps)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Actor damaged by explosive: %s"), *Actor->GetName());
-		UGameplayStatics::ApplyDamage(Actor, Damage, ShooterController, Shooter, UDamageType::StaticClass());
+		AActor* Actor{ Overlap.GetActor() };
+		if (Actor && (Actor->IsA<ACharacter>() || Actor->IsA<AExplosive>())) OutTargets.AddUnique(Actor);
 	}
+}
 
-	Destroy();
+void AExplosive::InitBlast(FPendingBlast& Blast) const
+{
+	Blast.Origin = GetActorLocation();
+	Blast.Damage = Damage;
+	Blast.MinimumDamage = MinimumDamage;
+	Blast.InnerRadius = InnerBlastRadius;
+	Blast.OuterRadius = BlastRadius;
+	Blast.DamageFalloff = DamageFalloff;
 }
 
+void AExplosive::Explode()
+{
+	if (ExplodeParticles) UFXPoolSubsystem::SpawnEmitterAtLocation(this, ExplodeParticles, GetActorLocation());
+
+	Destroy();
+}
@@ -9,8 +9,8 @@
 
 class UParticleSystem;
 class USoundCue;
-class USphereComponent;
 class UStaticMeshComponent;
+struct FPendingBlast;
 
 UCLASS()
 class BELICABADASS_API AExplosive : public AActor, public IBulletHitInterface
@@ -21,14 +21,16 @@ public:
 	// Sets default values for this actor's properties
 	AExplosive();
 
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 	virtual void BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController) override;
 
-protected:
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
+	// Characters and other Explosives within BlastRadius, found with one broadphase query
+	void GatherBlastTargets(TArray<AActor*>& OutTargets) const;
+
+	// Fills in Blast's origin and damage falloff from this Explosive
+	void InitBlast(FPendingBlast& Blast) const;
+
+	// Spawns the explosion FX and removes the Explosive, damage is applied by the explosion scheduler
+	void Explode();
 
 private:
 	// Explosion when hit by a bullet
@@ -39,10 +41,6 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	USoundCue* ImpactSound;
 
-	/* Used to determine what Actors overlap during explosion */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	USphereComponent* OverlapSphere;
-
 	/* Mesh for the explosive */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	UStaticMeshComponent* ExplosiveMesh;
@@ -51,7 +49,33 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float Damage;
 
+	/* Damage at the edge of the blast */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float MinimumDamage;
+
+	/* Targets closer than this take the full Damage */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float InnerBlastRadius;
+
+	/* Targets farther than this are not hit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float BlastRadius;
+
+	/* Exponent of the falloff from Damage to MinimumDamage, 1 is linear */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float DamageFalloff;
+
+	/* Object types the blast query looks for, only Characters and Explosives among them are hit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	TArray<TEnumAsByte<EObjectTypeQuery>> BlastObjectTypes;
+
+	/* True once the Explosive is waiting in the explosion scheduler */
+	bool bDetonationQueued;
+
 public:	
 	// Getters for private variables
+	FORCEINLINE float GetDamage() const { return Damage; }
+	FORCEINLINE bool IsDetonationQueued() const { return bDetonationQueued; }
+	FORCEINLINE void SetDetonationQueued(bool bQueued) { bDetonationQueued = bQueued; }
 
 };
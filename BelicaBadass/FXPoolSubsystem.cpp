@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FXPoolSubsystem.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "BelicaBadass.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled FX Active"), STAT_PooledFXActive, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled FX Components Created"), STAT_PooledFXCreated, STATGROUP_BelicaBadass);
+
+static FAutoConsoleCommandWithWorld DumpFXPoolsCommand(
+	TEXT("Belica.FXPool.Dump"),
+	TEXT("Logs active, free and high-water counts of the pooled particle system components."),
+	ObjectPool::MakeDumpCommand<UFXPoolSubsystem>());
+
+UFXPoolSubsystem::UFXPoolSubsystem() :
+	MaxFreePerTemplate(32)
+{
+}
+
+void UFXPoolSubsystem::Deinitialize()
+{
+	for (auto& PoolPair : Pools)
+	{
+		while (UParticleSystemComponent* Component{ PoolPair.Value.PopFree<UParticleSystemComponent>() }) Component->DestroyComponent();
+	}
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UFXPoolSubsystem::Prewarm(UParticleSystem* Template, int32 Count)
+{
+	if (Template == nullptr) return;
+
+	FObjectPool& Pool{ Pools.FindOrAdd(Template) };
+	while (Pool.FreeObjects.Num() < FMath::Min(Count, MaxFreePerTemplate))
+	{
+		Pool.AddFree(CreatePooledComponent(Template), MaxFreePerTemplate);
+	}
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnEmitter(UParticleSystem* Template, const FTransform& SpawnTransform)
+{
+	if (Template == nullptr) return nullptr;
+
+	FObjectPool& Pool{ Pools.FindOrAdd(Template) };
+	UParticleSystemComponent* Component{ Pool.PopFree<UParticleSystemComponent>() };
+	if (Component == nullptr) Component = CreatePooledComponent(Template);
+
+	Component->SetWorldTransform(SpawnTransform);
+	Component->ActivateSystem(true);
+
+	Pool.MarkAcquired();
+	INC_DWORD_STAT(STAT_PooledFXActive);
+
+	return Component;
+}
+
+void UFXPoolSubsystem::OnSystemFinished(UParticleSystemComponent* Component)
+{
+	if (Component == nullptr) return;
+
+	FObjectPool* Pool{ Pools.Find(Component->Template) };
+	if (Pool == nullptr)
+	{
+		Component->DestroyComponent();
+		return;
+	}
+
+	Pool->MarkReleased();
+	DEC_DWORD_STAT(STAT_PooledFXActive);
+
+	if (!Pool->AddFree(Component, MaxFreePerTemplate)) Component->DestroyComponent();
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::CreatePooledComponent(UParticleSystem* Template)
+{
+	UWorld* World{ GetWorld() };
+	AWorldSettings* WorldSettings{ World->GetWorldSettings() };
+	UObject* Outer{ WorldSettings ? static_cast<UObject*>(WorldSettings) : static_cast<UObject*>(World) };
+
+	UParticleSystemComponent* Component{ NewObject<UParticleSystemComponent>(Outer) };
+	Component->bAutoDestroy = false;
+	Component->bAutoActivate = false;
+	Component->SetAbsolute(true, true, true);
+	Component->SetTemplate(Template);
+	Component->OnSystemFinished.AddDynamic(this, &UFXPoolSubsystem::OnSystemFinished);
+	Component->RegisterComponentWithWorld(World);
+
+	INC_DWORD_STAT(STAT_PooledFXCreated);
+
+	return Component;
+}
+
+void UFXPoolSubsystem::DumpPoolStats() const
+{
+	ObjectPool::DumpPoolStats(TEXT("FX"), Pools);
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FTransform& SpawnTransform)
+{
+	if (Template == nullptr || WorldContextObject == nullptr) return nullptr;
+
+	UWorld* World{ WorldContextObject->GetWorld() };
+	UFXPoolSubsystem* FXPool{ World ? World->GetSubsystem<UFXPoolSubsystem>() : nullptr };
+	if (FXPool) return FXPool->SpawnEmitter(Template, SpawnTransform);
+
+	return UGameplayStatics::SpawnEmitterAtLocation(WorldContextObject, Template, SpawnTransform);
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	return SpawnEmitterAtLocation(WorldContextObject, Template, FTransform(Rotation, Location));
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ObjectPool.h"
+#include "FXPoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/**
+ * Hands out pre-allocated particle system components per template and takes them back once they finish,
+ * so firing and impacts don't create a new component for the GC to collect on every shot.
+ * Only use it for non-looping templates; a looping system never finishes and is never returned.
+ */
+UCLASS()
+class BELICABADASS_API UFXPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UFXPoolSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// Creates components for Template until Count of them are free in its pool
+	void Prewarm(UParticleSystem* Template, int32 Count);
+
+	// Plays Template at SpawnTransform with a component from its pool
+	UParticleSystemComponent* SpawnEmitter(UParticleSystem* Template, const FTransform& SpawnTransform);
+
+	// Logs active, free and high-water counts for every template
+	void DumpPoolStats() const;
+
+	// Spawns through the world's pool, falling back to UGameplayStatics when there is none
+	static UParticleSystemComponent* SpawnEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FTransform& SpawnTransform);
+	static UParticleSystemComponent* SpawnEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+
+protected:
+	// Returns a component to its pool when its system completes
+	UFUNCTION()
+	void OnSystemFinished(UParticleSystemComponent* Component);
+
+	UParticleSystemComponent* CreatePooledComponent(UParticleSystem* Template);
+
+private:
+	/* Pool of components for each particle template */
+	UPROPERTY()
+	TMap<UParticleSystem*, FObjectPool> Pools;
+
+	/* Finished components beyond this count are destroyed instead of pooled */
+	int32 MaxFreePerTemplate;
+};
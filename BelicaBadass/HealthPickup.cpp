@@ -10,8 +10,8 @@
 AHealthPickup::AHealthPickup() :
 	HealingAmount(20.f)
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Health pickups only react to overlaps and never need to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	HealthPickupMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("HealthPickupMesh"));
 	SetRootComponent(HealthPickupMesh);
@@ -20,11 +20,6 @@ AHealthPickup::AHealthPickup() :
 	HealthCollisionSphere->SetupAttachment(GetRootComponent());
 }
 
-void AHealthPickup::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 void AHealthPickup::BeginPlay()
 {
 	Super::BeginPlay();
@@ -17,8 +17,6 @@ class BELICABADASS_API AHealthPickup : public AActor
 public:
 	AHealthPickup();
 
-	virtual void Tick(float DeltaTime) override;
-
 protected:
 	virtual void BeginPlay() override;
 
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "HitNumberWidget.generated.h"
+
+/**
+ * Damage number shown where an Enemy was hit; instances are pooled by UCombatUISubsystem
+ */
+UCLASS()
+class BELICABADASS_API UHitNumberWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	// Called each time the widget is handed out to display a new hit
+	UFUNCTION(BlueprintImplementableEvent)
+	void SetHitNumber(int32 Damage, bool bHeadShot);
+};
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HitZoneDataAsset.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+
+TSharedPtr<const FCompiledHitZones> UHitZoneDataAsset::GetCompiledHitZones(const USkinnedMeshComponent* MeshComponent) const
+{
+	if (MeshComponent == nullptr || MeshComponent->SkeletalMesh == nullptr) return nullptr;
+
+	const TSharedPtr<const FCompiledHitZones>* Existing{ CompiledHitZones.Find(MeshComponent->SkeletalMesh) };
+	if (Existing) return *Existing;
+
+	TMap<FName, FHitZoneInfo> ZoneByName;
+	for (const FHitZoneBone& Bone : Bones)
+	{
+		ZoneByName.Add(Bone.BoneName, Bone.HitZone);
+	}
+
+	// Parents always come before their children, so each bone can inherit its parent's zone
+	TSharedRef<FCompiledHitZones> Compiled{ MakeShared<FCompiledHitZones>() };
+	Compiled->DefaultZone = DefaultZone;
+	const int32 NumBones{ MeshComponent->GetNumBones() };
+	Compiled->ZoneByBone.SetNum(NumBones);
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+	{
+		const FName BoneName{ MeshComponent->GetBoneName(BoneIndex) };
+		const FHitZoneInfo* ListedZone{ ZoneByName.Find(BoneName) };
+		if (ListedZone)
+		{
+			Compiled->ZoneByBone[BoneIndex] = *ListedZone;
+			continue;
+		}
+
+		const int32 ParentIndex{ MeshComponent->GetBoneIndex(MeshComponent->GetParentBone(BoneName)) };
+		Compiled->ZoneByBone[BoneIndex] = (ParentIndex != INDEX_NONE && ParentIndex < BoneIndex) ? Compiled->ZoneByBone[ParentIndex] : DefaultZone;
+	}
+
+	CompiledHitZones.Add(MeshComponent->SkeletalMesh, Compiled);
+	return Compiled;
+}
+
+#if WITH_EDITOR
+void UHitZoneDataAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	CompiledHitZones.Empty();
+}
+#endif
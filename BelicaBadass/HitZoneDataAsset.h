@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "HitZoneDataAsset.generated.h"
+
+class USkinnedMeshComponent;
+
+UENUM(BlueprintType)
+enum class EHitZone : uint8
+{
+	EHZ_Body UMETA(DisplayName = "Body"),
+	EHZ_Head UMETA(DisplayName = "Head"),
+	EHZ_Arm UMETA(DisplayName = "Arm"),
+	EHZ_Leg UMETA(DisplayName = "Leg"),
+	EHZ_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+USTRUCT(BlueprintType)
+struct FHitZoneInfo
+{
+	GENERATED_BODY()
+
+	FHitZoneInfo() {}
+	FHitZoneInfo(EHitZone InZone, float InDamageMultiplier) : Zone(InZone), DamageMultiplier(InDamageMultiplier) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EHitZone Zone{ EHitZone::EHZ_Body };
+
+	/* Scales the Weapon's damage for hits in this zone, ignored for Head which always deals the Weapon's HeadShotDamage */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DamageMultiplier{ 1.f };
+};
+
+USTRUCT(BlueprintType)
+struct FHitZoneBone
+{
+	GENERATED_BODY()
+
+	/* Bone that starts the zone, its child bones belong to the zone unless they're listed themselves */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName BoneName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FHitZoneInfo HitZone;
+};
+
+/* Hit zone of every bone of one skeletal mesh, indexed by bone index */
+struct FCompiledHitZones
+{
+	TArray<FHitZoneInfo> ZoneByBone;
+	FHitZoneInfo DefaultZone;
+
+	FORCEINLINE const FHitZoneInfo& Resolve(int32 BoneIndex) const
+	{
+		return ZoneByBone.IsValidIndex(BoneIndex) ? ZoneByBone[BoneIndex] : DefaultZone;
+	}
+};
+
+/* Point damage that carries the hit zone resolved by the shooter */
+struct FHitZoneDamageEvent : public FPointDamageEvent
+{
+	/* Zone of the Enemy that was hit */
+	EHitZone HitZone;
+
+	/* ID for this class, must be unique among damage events */
+	static const int32 ClassID = 101;
+
+	FHitZoneDamageEvent() : HitZone(EHitZone::EHZ_Body) {}
+	FHitZoneDamageEvent(float InDamage, const FHitResult& InHitInfo, const FVector& InShotDirection, TSubclassOf<UDamageType> InDamageTypeClass, EHitZone InHitZone) :
+		FPointDamageEvent(InDamage, InHitInfo, InShotDirection, InDamageTypeClass),
+		HitZone(InHitZone)
+	{
+	}
+
+	virtual int32 GetTypeID() const override { return FHitZoneDamageEvent::ClassID; }
+	virtual bool IsOfType(int32 InID) const override { return (FHitZoneDamageEvent::ClassID == InID) || FPointDamageEvent::IsOfType(InID); }
+};
+
+/**
+ * Maps bones to hit zones and damage multipliers, compiled once per skeletal mesh into a bone-indexed lookup
+ */
+UCLASS(BlueprintType)
+class BELICABADASS_API UHitZoneDataAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Returns the bone-indexed zones for the mesh used by MeshComponent, compiling them on first use
+	TSharedPtr<const FCompiledHitZones> GetCompiledHitZones(const USkinnedMeshComponent* MeshComponent) const;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	/* Bones that start a hit zone */
+	UPROPERTY(EditAnywhere, Category = "Hit Zones")
+	TArray<FHitZoneBone> Bones;
+
+	/* Zone for bones that aren't under any listed bone */
+	UPROPERTY(EditAnywhere, Category = "Hit Zones")
+	FHitZoneInfo DefaultZone;
+
+	/* Compiled zones for each skeletal mesh that has used this asset */
+	mutable TMap<TWeakObjectPtr<const UObject>, TSharedPtr<const FCompiledHitZones>> CompiledHitZones;
+};
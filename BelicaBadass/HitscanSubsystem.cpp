@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HitscanSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "BelicaBadass.h"
+
+static TAutoConsoleVariable<int32> CVarAsyncHitscan(
+	TEXT("Belica.AsyncHitscan"),
+	0,
+	TEXT("When 1, bullet traces queued during a frame are submitted as one batch of async traces and resolved when the hitscan subsystem ticks the next frame."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Hitscan Tick"), STAT_HitscanTick, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Traces Submitted"), STAT_HitscanTracesSubmitted, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Traces Lost"), STAT_HitscanTracesLost, STATGROUP_BelicaBadass);
+
+void UHitscanSubsystem::Deinitialize()
+{
+	QueuedTraces.Empty();
+	SubmittedTraces.Empty();
+
+	Super::Deinitialize();
+}
+
+void UHitscanSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HitscanTick);
+
+	// Resolve first, traces queued by the hits it applies go out with the rest of this frame's
+	if (SubmittedTraces.Num() > 0) ResolveSubmittedTraces();
+	if (QueuedTraces.Num() > 0) SubmitQueuedTraces();
+}
+
+TStatId UHitscanSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHitscanSubsystem, STATGROUP_Tickables);
+}
+
+void UHitscanSubsystem::QueueTrace(const FVector& Start, const FVector& End, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, float Timestamp, FOnHitscanResolved OnResolved)
+{
+	FPendingHitscan& Pending{ QueuedTraces.AddDefaulted_GetRef() };
+	Pending.TraceStart = Start;
+	Pending.TraceEnd = End;
+	Pending.TraceChannel = TraceChannel;
+	Pending.QueryParams = QueryParams;
+	Pending.Timestamp = Timestamp;
+	Pending.OnResolved = MoveTemp(OnResolved);
+}
+
+bool UHitscanSubsystem::IsEnabled()
+{
+	return CVarAsyncHitscan.GetValueOnGameThread() > 0;
+}
+
+void UHitscanSubsystem::ResolveSubmittedTraces()
+{
+	UWorld* World{ GetWorld() };
+
+	// Take the finished traces out first, resolving a hit may fire more shots and queue more traces
+	TArray<TPair<FPendingHitscan, FHitResult>> Resolving;
+	int32 LostCount{ 0 };
+	for (int32 i = SubmittedTraces.Num() - 1; i >= 0; i--)
+	{
+		FPendingHitscan& Pending{ SubmittedTraces[i] };
+		FHitResult HitResult(Pending.TraceStart, Pending.TraceEnd);
+
+		FTraceDatum TraceData;
+		if (World->QueryTraceData(Pending.Handle, TraceData))
+		{
+			if (TraceData.OutHits.Num() > 0) HitResult = TraceData.OutHits[0];
+		}
+		else if (World->IsTraceHandleValid(Pending.Handle, false))
+		{
+			continue;
+		}
+		else
+		{
+			// Results are only kept for the frame after the trace ran, a lost one is a bug in when they are read
+			++LostCount;
+		}
+
+		Resolving.Emplace(MoveTemp(Pending), HitResult);
+		SubmittedTraces.RemoveAtSwap(i, 1, false);
+	}
+
+	if (LostCount > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_HitscanTracesLost, LostCount);
+		ensureMsgf(false, TEXT("Hitscan trace results were lost before they were read"));
+		UE_LOG(LogTemp, Warning, TEXT("%d hitscan trace results were lost before they were read, resolving them as misses"), LostCount);
+	}
+
+	// Shooters queue in tick order, resolve in firing order so the first shot to land gets the damage and the kill
+	Resolving.StableSort([](const TPair<FPendingHitscan, FHitResult>& A, const TPair<FPendingHitscan, FHitResult>& B) { return A.Key.Timestamp < B.Key.Timestamp; });
+
+	for (TPair<FPendingHitscan, FHitResult>& Resolved : Resolving) Resolved.Key.OnResolved.ExecuteIfBound(Resolved.Value);
+}
+
+void UHitscanSubsystem::SubmitQueuedTraces()
+{
+	UWorld* World{ GetWorld() };
+	for (FPendingHitscan& Pending : QueuedTraces)
+	{
+		Pending.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Pending.TraceStart, Pending.TraceEnd, Pending.TraceChannel, Pending.QueryParams);
+	}
+	INC_DWORD_STAT_BY(STAT_HitscanTracesSubmitted, QueuedTraces.Num());
+
+	SubmittedTraces.Append(MoveTemp(QueuedTraces));
+	QueuedTraces.Reset();
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "HitscanSubsystem.generated.h"
+
+DECLARE_DELEGATE_OneParam(FOnHitscanResolved, const FHitResult&);
+
+/* Hitscan trace waiting to be submitted or for its results */
+struct FPendingHitscan
+{
+	FVector TraceStart{ FVector::ZeroVector };
+	FVector TraceEnd{ FVector::ZeroVector };
+	ECollisionChannel TraceChannel{ ECC_Visibility };
+	FCollisionQueryParams QueryParams;
+
+	/* World time the shot behind the trace fired at, results are handed back in this order */
+	float Timestamp{ 0.f };
+
+	/* Handle of the async trace once it has been submitted */
+	FTraceHandle Handle;
+
+	/* Called with the trace's hit, or a non-blocking result for a miss */
+	FOnHitscanResolved OnResolved;
+};
+
+/**
+ * Collects the hitscan traces of every shooter during a frame and submits them together as async traces once actors
+ * have ticked, then hands each result back when the subsystem ticks the next frame, where last frame's async results
+ * are guaranteed to be readable. Game-thread trace cost stays flat however many shots are fired, at the price of one
+ * frame of latency.
+ */
+UCLASS()
+class BELICABADASS_API UHitscanSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	// Queues a single line trace fired at Timestamp, OnResolved is called with its result next frame
+	void QueueTrace(const FVector& Start, const FVector& End, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, float Timestamp, FOnHitscanResolved OnResolved);
+
+	// True when shooters should go through QueueTrace instead of tracing right away
+	static bool IsEnabled();
+
+protected:
+	// Resolves the traces submitted last frame whose results are in
+	void ResolveSubmittedTraces();
+
+	// Submits the traces queued this frame as one batch
+	void SubmitQueuedTraces();
+
+private:
+	/* Traces queued this frame and not yet submitted */
+	TArray<FPendingHitscan> QueuedTraces;
+
+	/* Traces submitted on an earlier frame and waiting for their results */
+	TArray<FPendingHitscan> SubmittedTraces;
+};
@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImpactDecalSubsystem.h"
+#include "Components/DecalComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/WorldSettings.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+#include "BelicaBadass.h"
+
+static TAutoConsoleVariable<int32> CVarImpactDecalBudget(
+	TEXT("Belica.ImpactDecalBudget"),
+	128,
+	TEXT("Most bullet impact decals alive at once, the oldest is reused when a new one is needed. 0 turns impact decals off."),
+	ECVF_Default);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Impact Decal Components"), STAT_ImpactDecalComponents, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impact Decals Spawned"), STAT_ImpactDecalsSpawned, STATGROUP_BelicaBadass);
+
+void UImpactDecalSubsystem::Deinitialize()
+{
+	GetWorld()->GetTimerManager().ClearTimer(ExpiryTimer);
+	TrimToBudget(0);
+
+	Super::Deinitialize();
+}
+
+UDecalComponent* UImpactDecalSubsystem::SpawnDecal(UMaterialInterface* Material, const FVector& Size, const FVector& Location, const FRotator& Rotation, float LifeSpan, float FadeDuration)
+{
+	if (Material == nullptr) return nullptr;
+
+	const int32 Budget{ FMath::Max(CVarImpactDecalBudget.GetValueOnGameThread(), 0) };
+	if (Slots.Num() > Budget) TrimToBudget(Budget);
+	if (Budget == 0) return nullptr;
+
+	// Grow until the budget is reached by inserting ahead of the oldest decal, after that NextSlot always holds the oldest
+	if (Slots.Num() < Budget) Slots.InsertDefaulted(NextSlot);
+	FImpactDecalSlot& Slot{ Slots[NextSlot] };
+	NextSlot = (NextSlot + 1) % Budget;
+
+	if (!IsValid(Slot.Component)) Slot.Component = CreateDecalComponent();
+	if (Slot.Component->GetDecalMaterial() != Material) Slot.Component->SetDecalMaterial(Material);
+
+	// The render proxy times the fade from when it is recreated, so the component never ticks.
+	// The fields are set directly because SetFadeOut() arms a lifespan timer that destroys the component once it fades
+	Slot.Component->DecalSize = Size;
+	Slot.Component->SetWorldLocationAndRotation(Location, Rotation);
+	Slot.Component->FadeStartDelay = LifeSpan;
+	Slot.Component->FadeDuration = FadeDuration;
+	Slot.Component->SetVisibility(true);
+	Slot.Component->MarkRenderStateDirty();
+
+	Slot.ExpireTime = GetWorld()->GetTimeSeconds() + LifeSpan + FadeDuration;
+	ScheduleExpiry(Slot.ExpireTime);
+
+	INC_DWORD_STAT(STAT_ImpactDecalsSpawned);
+
+	return Slot.Component;
+}
+
+UDecalComponent* UImpactDecalSubsystem::CreateDecalComponent()
+{
+	UWorld* World{ GetWorld() };
+	AWorldSettings* WorldSettings{ World->GetWorldSettings() };
+	UObject* Outer{ WorldSettings ? static_cast<UObject*>(WorldSettings) : static_cast<UObject*>(World) };
+
+	UDecalComponent* Component{ NewObject<UDecalComponent>(Outer) };
+	Component->SetAbsolute(true, true, true);
+	Component->bDestroyOwnerAfterFade = false;
+	Component->RegisterComponentWithWorld(World);
+
+	INC_DWORD_STAT(STAT_ImpactDecalComponents);
+
+	return Component;
+}
+
+void UImpactDecalSubsystem::TrimToBudget(int32 Budget)
+{
+	if (Slots.Num() <= Budget) return;
+
+	// Rotate so the oldest slot is first, then drop the oldest ones
+	const int32 Oldest{ NextSlot < Slots.Num() ? NextSlot : 0 };
+	TArray<FImpactDecalSlot> Ordered;
+	Ordered.Reserve(Slots.Num());
+	for (int32 i = 0; i < Slots.Num(); i++) Ordered.Add(Slots[(Oldest + i) % Slots.Num()]);
+
+	const int32 RemoveCount{ Ordered.Num() - Budget };
+	for (int32 i = 0; i < RemoveCount; i++)
+	{
+		if (IsValid(Ordered[i].Component))
+		{
+			Ordered[i].Component->DestroyComponent();
+			DEC_DWORD_STAT(STAT_ImpactDecalComponents);
+		}
+	}
+	Ordered.RemoveAt(0, RemoveCount);
+
+	Slots = MoveTemp(Ordered);
+	NextSlot = Budget > 0 ? Slots.Num() % Budget : 0;
+}
+
+void UImpactDecalSubsystem::HideExpiredDecals()
+{
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	float NextExpireTime{ TNumericLimits<float>::Max() };
+	for (FImpactDecalSlot& Slot : Slots)
+	{
+		if (!IsValid(Slot.Component) || !Slot.Component->IsVisible()) continue;
+
+		if (Slot.ExpireTime <= Now) Slot.Component->SetVisibility(false);
+		else NextExpireTime = FMath::Min(NextExpireTime, Slot.ExpireTime);
+	}
+
+	if (NextExpireTime < TNumericLimits<float>::Max()) ScheduleExpiry(NextExpireTime);
+}
+
+void UImpactDecalSubsystem::ScheduleExpiry(float ExpireTime)
+{
+	FTimerManager& TimerManager{ GetWorld()->GetTimerManager() };
+	const float Delay{ FMath::Max(ExpireTime - GetWorld()->GetTimeSeconds(), KINDA_SMALL_NUMBER) };
+	if (TimerManager.IsTimerActive(ExpiryTimer) && TimerManager.GetTimerRemaining(ExpiryTimer) <= Delay) return;
+
+	TimerManager.SetTimer(ExpiryTimer, this, &UImpactDecalSubsystem::HideExpiredDecals, Delay);
+}
+
+UDecalComponent* UImpactDecalSubsystem::SpawnDecalAtLocation(const UObject* WorldContextObject, UMaterialInterface* Material, const FVector& Size, const FVector& Location, const FRotator& Rotation, float LifeSpan, float FadeDuration)
+{
+	if (Material == nullptr || WorldContextObject == nullptr) return nullptr;
+
+	UWorld* World{ WorldContextObject->GetWorld() };
+	UImpactDecalSubsystem* ImpactDecals{ World ? World->GetSubsystem<UImpactDecalSubsystem>() : nullptr };
+	if (ImpactDecals) return ImpactDecals->SpawnDecal(Material, Size, Location, Rotation, LifeSpan, FadeDuration);
+
+	UDecalComponent* Decal{ UGameplayStatics::SpawnDecalAtLocation(WorldContextObject, Material, Size, Location, Rotation) };
+	if (Decal) Decal->SetFadeOut(LifeSpan, FadeDuration, true);
+	return Decal;
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpactDecalSubsystem.generated.h"
+
+class UDecalComponent;
+class UMaterialInterface;
+
+USTRUCT()
+struct FImpactDecalSlot
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UDecalComponent* Component{ nullptr };
+
+	/* World time the decal has finished fading, it is hidden after that */
+	float ExpireTime{ 0.f };
+};
+
+/**
+ * Keeps bullet impact decals in a fixed-size ring of components sized by Belica.ImpactDecalBudget,
+ * reusing the oldest decal once the ring is full so sustained fire never grows the component count.
+ * Nothing ticks and components live for the whole session: each decal's fade values are read by its material
+ * through a DecalLifetimeOpacity node, and one timer hides the ones that have finished fading.
+ */
+UCLASS()
+class BELICABADASS_API UImpactDecalSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Shows Material at Location in the next ring slot for LifeSpan seconds, then fades it out over FadeDuration
+	UDecalComponent* SpawnDecal(UMaterialInterface* Material, const FVector& Size, const FVector& Location, const FRotator& Rotation, float LifeSpan, float FadeDuration);
+
+	// Spawns through the world's ring, falling back to UGameplayStatics when there is none
+	static UDecalComponent* SpawnDecalAtLocation(const UObject* WorldContextObject, UMaterialInterface* Material, const FVector& Size, const FVector& Location, const FRotator& Rotation, float LifeSpan, float FadeDuration);
+
+protected:
+	UDecalComponent* CreateDecalComponent();
+
+	// Destroys slots beyond Budget, keeping the ring's oldest-first order for the slots that remain
+	void TrimToBudget(int32 Budget);
+
+	// Hides every slot that has finished fading and waits for the next one to
+	void HideExpiredDecals();
+
+	// Makes sure the expiry timer fires no later than ExpireTime
+	void ScheduleExpiry(float ExpireTime);
+
+private:
+	/* Ring of decal slots, NextSlot is the oldest once it is full */
+	UPROPERTY()
+	TArray<FImpactDecalSlot> Slots;
+
+	/* Slot the next decal goes into */
+	int32 NextSlot{ 0 };
+
+	FTimerHandle ExpiryTimer;
+};
@@ -0,0 +1,199 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryComponent.h"
+
+// Sets default values for this component's properties
+UInventoryComponent::UInventoryComponent() :
+	Capacity(6),
+	bStackIdenticalWeapons(false),
+	MaxWeaponStack(1),
+	MaxAmmoPerType(999),
+	HeldSlot(INDEX_NONE),
+	NumOccupied(0)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bWantsInitializeComponent = true;
+
+	for (int32& Count : Ammo) Count = 0;
+}
+
+void UInventoryComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	Slots.SetNum(Capacity);
+	OccupiedSlots.Init(false, Capacity);
+
+	// Lowest slot on top so a fresh Inventory fills in order
+	FreeSlots.Reset(Capacity);
+	FreeSlotPositions.SetNumUninitialized(Capacity);
+	for (int32 i = Capacity - 1; i >= 0; i--) FreeSlotPositions[i] = FreeSlots.Add(i);
+	OpenStacks.Empty();
+	HeldSlot = INDEX_NONE;
+	NumOccupied = 0;
+}
+
+int32 UInventoryComponent::AddWeapon(const FWeaponRecord& Record)
+{
+	if (bStackIdenticalWeapons)
+	{
+		const int32* OpenSlot{ OpenStacks.Find(FWeaponStackKey(Record)) };
+		if (OpenSlot)
+		{
+			const int32 SlotIndex{ *OpenSlot };
+			FWeaponRecord& Stack{ Slots[SlotIndex] };
+			Stack.StackCount = FMath::Min(Stack.StackCount + Record.StackCount, MaxWeaponStack);
+			if (Stack.StackCount >= MaxWeaponStack) CloseStack(SlotIndex);
+
+			OnSlotChanged.Broadcast(this, SlotIndex);
+			return SlotIndex;
+		}
+	}
+
+	const int32 SlotIndex{ GetFreeSlot() };
+	if (SlotIndex == INDEX_NONE) return INDEX_NONE;
+
+	SetSlot(SlotIndex, Record);
+	return SlotIndex;
+}
+
+void UInventoryComponent::SetSlot(int32 SlotIndex, const FWeaponRecord& Record)
+{
+	if (!Slots.IsValidIndex(SlotIndex)) return;
+
+	CloseStack(SlotIndex);
+	if (!OccupiedSlots[SlotIndex]) MarkOccupied(SlotIndex);
+
+	FWeaponRecord& Slot{ Slots[SlotIndex] };
+	Slot = Record;
+	Slot.SlotIndex = SlotIndex;
+	Slot.StackCount = FMath::Clamp(Slot.StackCount, 1, bStackIdenticalWeapons ? MaxWeaponStack : 1);
+
+	OpenStack(SlotIndex);
+
+	OnSlotChanged.Broadcast(this, SlotIndex);
+}
+
+void UInventoryComponent::RemoveWeapon(int32 SlotIndex)
+{
+	if (!IsSlotOccupied(SlotIndex)) return;
+
+	FWeaponRecord& Slot{ Slots[SlotIndex] };
+	if (--Slot.StackCount > 0)
+	{
+		OpenStack(SlotIndex);
+	}
+	else
+	{
+		CloseStack(SlotIndex);
+		Slot = FWeaponRecord();
+		MarkFree(SlotIndex);
+	}
+
+	OnSlotChanged.Broadcast(this, SlotIndex);
+}
+
+void UInventoryComponent::SetHeldSlot(int32 SlotIndex)
+{
+	const int32 PreviousHeldSlot{ HeldSlot };
+	CloseStack(SlotIndex);
+	HeldSlot = SlotIndex;
+
+	if (PreviousHeldSlot != SlotIndex && IsSlotOccupied(PreviousHeldSlot)) OpenStack(PreviousHeldSlot);
+}
+
+const FWeaponRecord* UInventoryComponent::GetSlot(int32 SlotIndex) const
+{
+	return IsSlotOccupied(SlotIndex) ? &Slots[SlotIndex] : nullptr;
+}
+
+int32 UInventoryComponent::GetFreeSlot() const
+{
+	return FreeSlots.Num() > 0 ? FreeSlots.Last() : INDEX_NONE;
+}
+
+bool UInventoryComponent::GetSlotRecord(int32 SlotIndex, FWeaponRecord& OutRecord) const
+{
+	const FWeaponRecord* Record{ GetSlot(SlotIndex) };
+	if (Record == nullptr) return false;
+
+	OutRecord = *Record;
+	return true;
+}
+
+bool UInventoryComponent::IsSlotOccupied(int32 SlotIndex) const
+{
+	return OccupiedSlots.IsValidIndex(SlotIndex) && OccupiedSlots[SlotIndex];
+}
+
+int32 UInventoryComponent::GetAmmo(EAmmoType AmmoType) const
+{
+	const int32 Index{ static_cast<int32>(AmmoType) };
+	return Index < static_cast<int32>(EAmmoType::EAT_MAX) ? Ammo[Index] : 0;
+}
+
+int32 UInventoryComponent::AddAmmo(EAmmoType AmmoType, int32 Amount)
+{
+	const int32 Index{ static_cast<int32>(AmmoType) };
+	if (Index >= static_cast<int32>(EAmmoType::EAT_MAX) || Amount <= 0) return 0;
+
+	const int32 Added{ FMath::Min(Amount, MaxAmmoPerType - Ammo[Index]) };
+	if (Added <= 0) return 0;
+
+	Ammo[Index] += Added;
+	OnAmmoChanged.Broadcast(this, AmmoType, Ammo[Index]);
+	return Added;
+}
+
+int32 UInventoryComponent::TakeAmmo(EAmmoType AmmoType, int32 Amount)
+{
+	const int32 Index{ static_cast<int32>(AmmoType) };
+	if (Index >= static_cast<int32>(EAmmoType::EAT_MAX) || Amount <= 0) return 0;
+
+	const int32 Taken{ FMath::Min(Amount, Ammo[Index]) };
+	if (Taken <= 0) return 0;
+
+	Ammo[Index] -= Taken;
+	OnAmmoChanged.Broadcast(this, AmmoType, Ammo[Index]);
+	return Taken;
+}
+
+void UInventoryComponent::MarkOccupied(int32 SlotIndex)
+{
+	// Fill the taken slot's place in the stack with the top one
+	const int32 Position{ FreeSlotPositions[SlotIndex] };
+	const int32 TopSlot{ FreeSlots.Pop(false) };
+	if (TopSlot != SlotIndex)
+	{
+		FreeSlots[Position] = TopSlot;
+		FreeSlotPositions[TopSlot] = Position;
+	}
+	FreeSlotPositions[SlotIndex] = INDEX_NONE;
+
+	OccupiedSlots[SlotIndex] = true;
+	++NumOccupied;
+}
+
+void UInventoryComponent::MarkFree(int32 SlotIndex)
+{
+	FreeSlotPositions[SlotIndex] = FreeSlots.Add(SlotIndex);
+
+	OccupiedSlots[SlotIndex] = false;
+	--NumOccupied;
+}
+
+void UInventoryComponent::OpenStack(int32 SlotIndex)
+{
+	const FWeaponRecord& Slot{ Slots[SlotIndex] };
+	if (bStackIdenticalWeapons && SlotIndex != HeldSlot && Slot.StackCount < MaxWeaponStack) OpenStacks.FindOrAdd(FWeaponStackKey(Slot), SlotIndex);
+}
+
+void UInventoryComponent::CloseStack(int32 SlotIndex)
+{
+	if (!IsSlotOccupied(SlotIndex)) return;
+
+	const FWeaponStackKey Key{ Slots[SlotIndex] };
+	const int32* OpenSlot{ OpenStacks.Find(Key) };
+	if (OpenSlot && *OpenSlot == SlotIndex) OpenStacks.Remove(Key);
+}
@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Containers/StaticArray.h"
+#include "AmmoType.h"
+#include "Weapon.h"
+#include "InventoryComponent.generated.h"
+
+class UInventoryComponent;
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnInventorySlotChanged, UInventoryComponent* /*Inventory*/, int32 /*SlotIndex*/);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnInventoryAmmoChanged, UInventoryComponent* /*Inventory*/, EAmmoType /*AmmoType*/, int32 /*NewCount*/);
+
+/** Fields two Weapon records must share to stack in one slot */
+struct FWeaponStackKey
+{
+	explicit FWeaponStackKey(const FWeaponRecord& Record) :
+		WeaponClass(Record.WeaponClass),
+		WeaponType(Record.WeaponType),
+		Rarity(Record.Rarity),
+		Ammo(Record.Ammo)
+	{
+	}
+
+	bool operator==(const FWeaponStackKey& Other) const
+	{
+		return WeaponClass == Other.WeaponClass && WeaponType == Other.WeaponType && Rarity == Other.Rarity && Ammo == Other.Ammo;
+	}
+
+	friend uint32 GetTypeHash(const FWeaponStackKey& Key)
+	{
+		uint32 Hash{ GetTypeHash(Key.WeaponClass.Get()) };
+		Hash = HashCombine(Hash, GetTypeHash(Key.WeaponType));
+		Hash = HashCombine(Hash, GetTypeHash(Key.Rarity));
+		return HashCombine(Hash, GetTypeHash(Key.Ammo));
+	}
+
+	TSubclassOf<AWeapon> WeaponClass;
+	EWeaponType WeaponType;
+	EItemRarity Rarity;
+	int32 Ammo;
+};
+
+/**
+ * Weapon records in a configurable number of slots plus carried ammo per EAmmoType.
+ * Occupied slots are tracked in a bitset, free slots on a stack and open weapon stacks in a map, so adding,
+ * removing and stacking don't scan the slots; crates and bots can hold dozens of entries.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class BELICABADASS_API UInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UInventoryComponent();
+
+	virtual void InitializeComponent() override;
+
+	// Puts Record in the first free slot, or on an open stack of identical Weapons when stacking is on; returns the slot or INDEX_NONE when full
+	int32 AddWeapon(const FWeaponRecord& Record);
+
+	// Replaces whatever is in SlotIndex with Record
+	void SetSlot(int32 SlotIndex, const FWeaponRecord& Record);
+
+	// Takes one Weapon off SlotIndex, freeing the slot once its stack is empty
+	void RemoveWeapon(int32 SlotIndex);
+
+	// Marks SlotIndex as held out as an actor, e.g. the equipped Weapon; its record goes stale so nothing stacks onto it until another slot is held
+	void SetHeldSlot(int32 SlotIndex);
+
+	// Record in SlotIndex, or nullptr when the slot is empty
+	const FWeaponRecord* GetSlot(int32 SlotIndex) const;
+
+	// Most recently emptied free slot, lowest first while none has been emptied, or INDEX_NONE when the Inventory is full
+	int32 GetFreeSlot() const;
+
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	bool GetSlotRecord(int32 SlotIndex, FWeaponRecord& OutRecord) const;
+
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	bool IsSlotOccupied(int32 SlotIndex) const;
+
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	int32 GetAmmo(EAmmoType AmmoType) const;
+
+	// Adds up to Amount of AmmoType without going over MaxAmmoPerType, returns how much was added
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	int32 AddAmmo(EAmmoType AmmoType, int32 Amount);
+
+	// Takes up to Amount of AmmoType, returns how much was taken
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	int32 TakeAmmo(EAmmoType AmmoType, int32 Amount);
+
+	/* Broadcast whenever a slot's record changes or the slot is emptied */
+	FOnInventorySlotChanged OnSlotChanged;
+
+	/* Broadcast whenever the carried count of an ammo type changes */
+	FOnInventoryAmmoChanged OnAmmoChanged;
+
+protected:
+	// Moves SlotIndex between the free slot stack and the occupied slots
+	void MarkOccupied(int32 SlotIndex);
+	void MarkFree(int32 SlotIndex);
+
+	// Lets identical Weapons stack onto SlotIndex while it has room and isn't held
+	void OpenStack(int32 SlotIndex);
+
+	// Forgets the open stack in SlotIndex, if any
+	void CloseStack(int32 SlotIndex);
+
+private:
+	/* Number of slots */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int32 Capacity;
+
+	/* When true identical Weapons share a slot, e.g. for crates */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
+	bool bStackIdenticalWeapons;
+
+	/* Most identical Weapons one slot can hold when stacking */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int32 MaxWeaponStack;
+
+	/* Most Ammo of one type the Inventory can carry */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 MaxAmmoPerType;
+
+	/* Weapon records indexed by slot, only meaningful where OccupiedSlots is set */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
+	TArray<FWeaponRecord> Slots;
+
+	/* True for each occupied slot */
+	TBitArray<> OccupiedSlots;
+
+	/* Free slots, the next one to fill on top */
+	TArray<int32> FreeSlots;
+
+	/* Where each free slot sits in FreeSlots so any of them can be taken out directly, INDEX_NONE while occupied */
+	TArray<int32> FreeSlotPositions;
+
+	/* Slot holding a stack with room left, by stack key */
+	TMap<FWeaponStackKey, int32> OpenStacks;
+
+	/* Slot whose Weapon is out as an actor, never an open stack */
+	int32 HeldSlot;
+
+	/* Carried Ammo indexed by EAmmoType */
+	TStaticArray<int32, static_cast<uint32>(EAmmoType::EAT_MAX)> Ammo;
+
+	int32 NumOccupied;
+
+public:
+	FORCEINLINE int32 GetCapacity() const { return Capacity; }
+	FORCEINLINE bool IsFull() const { return NumOccupied >= Capacity; }
+	FORCEINLINE int32 GetNumOccupied() const { return NumOccupied; }
+};
@@ -9,7 +9,32 @@
 #include "Camera/CameraComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
-#include "Curves/CurveVector.h"
+#include "ItemDataSubsystem.h"
+
+namespace ItemCollision
+{
+	FCollisionResponseContainer MakeResponses(ECollisionResponse DefaultResponse, ECollisionChannel BlockingChannel = ECC_MAX)
+	{
+		FCollisionResponseContainer Responses{ DefaultResponse };
+		if (BlockingChannel != ECC_MAX) Responses.SetResponse(BlockingChannel, ECR_Block);
+		return Responses;
+	}
+
+	const FItemCollisionProfile NoCollision{ TEXT("NoCollision"), ECollisionEnabled::NoCollision, MakeResponses(ECR_Ignore), false };
+	const FItemCollisionProfile PickupArea{ TEXT("PickupArea"), ECollisionEnabled::QueryOnly, MakeResponses(ECR_Overlap), false };
+	const FItemCollisionProfile TraceTarget{ TEXT("TraceTarget"), ECollisionEnabled::QueryAndPhysics, MakeResponses(ECR_Ignore, ECC_Visibility), false };
+	const FItemCollisionProfile Falling{ TEXT("Falling"), ECollisionEnabled::QueryAndPhysics, MakeResponses(ECR_Ignore, ECC_WorldStatic), true };
+
+	/* Mesh, AreaSphere and CollisionBox profiles in EItemState order */
+	const FItemStateProfile StateProfiles[]{
+		{ &NoCollision, &PickupArea, &TraceTarget, true, false },	// Pickup
+		{ &NoCollision, &NoCollision, &NoCollision, true, true },	// EquipInterping
+		{ &NoCollision, &NoCollision, &NoCollision, false, true },	// PickedUp
+		{ &NoCollision, &NoCollision, &NoCollision, true, true },	// Equipped
+		{ &Falling, &NoCollision, nullptr, true, false }			// Falling
+	};
+	static_assert(UE_ARRAY_COUNT(StateProfiles) == static_cast<int32>(EItemState::EIS_MAX), "Every item state needs a profile");
+}
 
 // Sets default values
 AItem::AItem() :
@@ -29,7 +54,7 @@ AItem::AItem() :
 	InterpLocIndex(0),
 	MaterialIndex(0),
 	bCanChangeCustomDepth(true),
-	// Dynamic Material Parameters
+	// Glow material parameters
 	GlowAmount(150.f),
 	FresnelExponent(3.f),
 	FresnelReflectFraction(4.f),
@@ -39,6 +64,7 @@ AItem::AItem() :
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Item Mesh"));
 	SetRootComponent(ItemMesh);
@@ -71,7 +97,9 @@ void AItem::BeginPlay()
 	
 	InitializeCustomDepth();
 
-	StartPulseTimer();
+	if (ItemState == EItemState::EIS_Pickup) StartPulse();
+
+	RefreshTickEnabled();
 }
 
 void AItem::OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -137,83 +165,35 @@ void AItem::SetActiveStars()
 
 void AItem::SetItemProperties(EItemState State)
 {
-	switch (State)
-	{
-	case EItemState::EIS_Pickup:
-		// Set ItemMesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECR_Overlap);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECR_Ignore);
-		CollisionBox->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		break;
-	case EItemState::EIS_EquipInterping:
-		PickupWidget->SetVisibility(false);
-		// Set ItemMesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_PickedUp:
-		PickupWidget->SetVisibility(false);
-		// Set ItemMesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(false);
-		ItemMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_Equipped:
-		PickupWidget->SetVisibility(false);
-		// Set ItemMesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_Falling:
-		// Set ItemMesh properties
-		ItemMesh->SetSimulatePhysics(true);
-		ItemMesh->SetEnableGravity(true);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		ItemMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
-		ItemMesh->SetCollisionResponseToChannel(ECC_WorldStatic, ECR_Block);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	default:
-		break;
-	}
+	const FItemStateProfile* Profile{ GetStateProfile(State) };
+	if (Profile == nullptr) return;
+
+	if (Profile->bHidePickupWidget) PickupWidget->SetVisibility(false);
+	ItemMesh->SetVisibility(Profile->bMeshVisible);
+
+	if (Profile->Mesh) ApplyCollisionProfile(ItemMesh, *Profile->Mesh);
+	if (Profile->AreaSphere) ApplyCollisionProfile(AreaSphere, *Profile->AreaSphere);
+	if (Profile->CollisionBox) ApplyCollisionProfile(CollisionBox, *Profile->CollisionBox);
+}
+
+const FItemStateProfile* AItem::GetStateProfile(EItemState State)
+{
+	const int32 Index{ static_cast<int32>(State) };
+	return Index < static_cast<int32>(UE_ARRAY_COUNT(ItemCollision::StateProfiles)) ? &ItemCollision::StateProfiles[Index] : nullptr;
+}
+
+void AItem::ApplyCollisionProfile(UPrimitiveComponent* Component, const FItemCollisionProfile& Profile)
+{
+	// Stop simulating before collision is switched off, start only once collision is back on
+	const bool bPhysicsChanged{ Component->IsSimulatingPhysics() != Profile.bSimulatePhysics };
+	if (bPhysicsChanged && !Profile.bSimulatePhysics) Component->SetSimulatePhysics(false);
+	if (Component->IsGravityEnabled() != Profile.bSimulatePhysics) Component->SetEnableGravity(Profile.bSimulatePhysics);
+
+	// One call for every channel instead of resetting them all and then overriding one
+	if (Component->GetCollisionResponseToChannels() != Profile.Responses) Component->SetCollisionResponseToChannels(Profile.Responses);
+	if (Component->GetCollisionEnabled() != Profile.CollisionEnabled) Component->SetCollisionEnabled(Profile.CollisionEnabled);
+
+	if (bPhysicsChanged && Profile.bSimulatePhysics) Component->SetSimulatePhysics(true);
 }
 
 void AItem::FinishInterping()
@@ -227,9 +207,12 @@ void AItem::FinishInterping()
 	}
 
 	SetActorScale3D(FVector(1.f));
+	SetPulseData(EItemPulseMode::None, 0.f, 0.f);
 	DisableGlowMaterial();
 	bCanChangeCustomDepth = true;
 	DisableCustomDepth();
+
+	RefreshTickEnabled();
 }
 
 void AItem::ItemInterp(float DeltaTime)
@@ -308,101 +291,66 @@ void AItem::InitializeCustomDepth()
 
 void AItem::OnConstruction(const FTransform& Transform)
 {
-	// Load the data in the ItemRarityDataTable
-	FString RarityTablePath(TEXT("DataTable'/Game/_Game/DataTables/ItemRarityDataTable.ItemRarityDataTable'"));
-	UDataTable* RarityTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *RarityTablePath));
-	if (RarityTableObject)
-	{
-		FItemRarityTable* RarityRow = nullptr;
-		switch (ItemRarity)
-		{
-		case EItemRarity::EIR_Damaged:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Damaged"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Common:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Common"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Uncommon:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Uncommon"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Rare:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Rare"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Legendary:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Legendary"), TEXT(""));
-			break;
-		}
+	ApplyItemData();
+}
 
-		if (RarityRow)
-		{
-			GlowColor = RarityRow->GlowColor;
-			LightColor = RarityRow->LightColor;
-			DarkColor = RarityRow->DarkColor;
-			NumberOfStars = RarityRow->NumberOfStars;
-			IconBackground = RarityRow->IconBackground;
-			if (GetItemMesh()) GetItemMesh()->SetCustomDepthStencilValue(RarityRow->CustomDepthStencil);
-		}
+void AItem::ApplyItemData()
+{
+	// Rarity data comes from the cached item data registry
+	UItemDataSubsystem* ItemData{ UItemDataSubsystem::Get() };
+	if (ItemData == nullptr) return;
 
-		if (MaterialInstance)
-		{
-			DynamicMaterialInstance = UMaterialInstanceDynamic::Create(MaterialInstance, this);
-			DynamicMaterialInstance->SetVectorParameterValue(TEXT("FresnelColor"), GlowColor);
-			ItemMesh->SetMaterial(MaterialIndex, DynamicMaterialInstance);
-			EnableGlowMaterial();
-		}
+	const FItemRarityTable* RarityRow{ ItemData->GetRarityData(ItemRarity) };
+	if (RarityRow)
+	{
+		GlowColor = RarityRow->GlowColor;
+		LightColor = RarityRow->LightColor;
+		DarkColor = RarityRow->DarkColor;
+		NumberOfStars = RarityRow->NumberOfStars;
+		IconBackground = RarityRow->IconBackground;
+		if (GetItemMesh()) GetItemMesh()->SetCustomDepthStencilValue(RarityRow->CustomDepthStencil);
 	}
+
+	ApplyGlowMaterial();
 }
 
 void AItem::EnableGlowMaterial()
 {
-	if (DynamicMaterialInstance) DynamicMaterialInstance->SetScalarParameterValue(TEXT("GlowBlendAlpha"), 0);
+	ItemMesh->SetCustomPrimitiveDataFloat(EItemGlowData::GlowBlendAlpha, 0.f);
 }
 
-void AItem::ResetPulseTimer()
+void AItem::ApplyGlowMaterial()
 {
-	StartPulseTimer();
+	if (MaterialInstance == nullptr) return;
+
+	// Every Item shares the material instance, the per-item values travel as primitive data instead of a MID
+	ItemMesh->SetMaterial(MaterialIndex, MaterialInstance);
+	ItemMesh->SetCustomPrimitiveDataVector3(EItemGlowData::GlowColorR, FVector(GlowColor.R, GlowColor.G, GlowColor.B));
+	ItemMesh->SetCustomPrimitiveDataFloat(EItemGlowData::GlowAmount, GlowAmount);
+	ItemMesh->SetCustomPrimitiveDataFloat(EItemGlowData::FresnelExponent, FresnelExponent);
+	ItemMesh->SetCustomPrimitiveDataFloat(EItemGlowData::FresnelReflectFraction, FresnelReflectFraction);
+	EnableGlowMaterial();
 }
 
-void AItem::StartPulseTimer()
+void AItem::SetPulseData(float Mode, float StartTime, float Period)
 {
-	if (ItemState == EItemState::EIS_Pickup) GetWorldTimerManager().SetTimer(PulseTimer, this, &AItem::ResetPulseTimer, PulseCurveTime);
+	ItemMesh->SetCustomPrimitiveDataFloat(EItemGlowData::PulseMode, Mode);
+	ItemMesh->SetCustomPrimitiveDataFloat(EItemGlowData::PulseStartTime, StartTime);
+	ItemMesh->SetCustomPrimitiveDataFloat(EItemGlowData::PulsePeriod, Period);
 }
 
-void AItem::UpdatePulse()
+void AItem::StartPulse()
 {
-	float ElapsedTime{};
-	FVector CurveValue{};
+	if (ItemState != EItemState::EIS_Pickup) return;
 
-	switch (ItemState)
-	{
-	case EItemState::EIS_Pickup:
-		if (PulseCurve)
-		{
-			ElapsedTime = GetWorldTimerManager().GetTimerElapsed(PulseTimer);
-			CurveValue = PulseCurve->GetVectorValue(ElapsedTime);
-		}
-		break;
-	case EItemState::EIS_EquipInterping:
-		if (InterpPulseCurve)
-		{
-			ElapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
-			CurveValue = InterpPulseCurve->GetVectorValue(ElapsedTime);
-		}
-		break;
-	default:
-		break;
-	}
-	if (DynamicMaterialInstance)
-	{
-		DynamicMaterialInstance->SetScalarParameterValue(TEXT("GlowAmount"), CurveValue.X * GlowAmount);
-		DynamicMaterialInstance->SetScalarParameterValue(TEXT("FresnelExponent"), CurveValue.Y * FresnelExponent);
-		DynamicMaterialInstance->SetScalarParameterValue(TEXT("FresnelReflectFraction"), CurveValue.Z * FresnelReflectFraction);
-	}
+	// Starting somewhere in the last period offsets the phase without any timer
+	const float Now{ static_cast<float>(GetWorld()->GetTimeSeconds()) };
+	SetPulseData(EItemPulseMode::Pickup, Now - FMath::FRandRange(0.f, PulseCurveTime), PulseCurveTime);
 }
 
 void AItem::DisableGlowMaterial()
 {
-	if (DynamicMaterialInstance) DynamicMaterialInstance->SetScalarParameterValue(TEXT("GlowBlendAlpha"), 1);
+	ItemMesh->SetCustomPrimitiveDataFloat(EItemGlowData::GlowBlendAlpha, 1.f);
 }
 
 void AItem::PlayEquipSound()
@@ -429,7 +377,7 @@ void AItem::StartItemCurve(AShooterCharacter* Char)
 	ItemInterpStartLocation = GetActorLocation();
 	bInterping = true;
 	SetItemState(EItemState::EIS_EquipInterping);
-	GetWorldTimerManager().ClearTimer(PulseTimer);
+	SetPulseData(EItemPulseMode::Interp, static_cast<float>(GetWorld()->GetTimeSeconds()), ZCurveTime);
 
 	GetWorldTimerManager().SetTimer(ItemInterpTimer, this, &AItem::FinishInterping, ZCurveTime);
 
@@ -445,13 +393,24 @@ void AItem::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 
 	ItemInterp(DeltaTime);
-
-	UpdatePulse();
 }
 
 void AItem::SetItemState(EItemState State)
 {
 	ItemState = State;
 	SetItemProperties(State);
+
+	RefreshTickEnabled();
+}
+
+bool AItem::NeedsTick() const
+{
+	return bInterping;
+}
+
+void AItem::RefreshTickEnabled()
+{
+	const bool bNeedsTick{ NeedsTick() };
+	if (IsActorTickEnabled() != bNeedsTick) SetActorTickEnabled(bNeedsTick);
 }
 
@@ -13,7 +13,6 @@ class USphereComponent;
 class AShooterCharacter;
 class UCurveFloat;
 class USoundCue;
-class UCurveVector;
 class UDataTable;
 
 UENUM(BlueprintType)
@@ -46,6 +45,52 @@ enum class EItemType : uint8
 	EIT_MAX UMETA(DisplayName = "DefaultMAX")
 };
 
+/* Custom primitive data written to the Item's mesh; the glow material reads the pulse from these and material time */
+namespace EItemGlowData
+{
+	enum Type : int32
+	{
+		GlowColorR,
+		GlowColorG,
+		GlowColorB,
+		GlowBlendAlpha,
+		PulseMode,
+		PulseStartTime,
+		PulsePeriod,
+		GlowAmount,
+		FresnelExponent,
+		FresnelReflectFraction,
+		Num
+	};
+}
+
+/* Pulse played by the glow material, written to EItemGlowData::PulseMode */
+namespace EItemPulseMode
+{
+	constexpr float None{ 0.f };
+	constexpr float Pickup{ 1.f };
+	constexpr float Interp{ 2.f };
+}
+
+/* Collision and physics settings for one of an Item's components */
+struct FItemCollisionProfile
+{
+	const TCHAR* Name;
+	ECollisionEnabled::Type CollisionEnabled;
+	FCollisionResponseContainer Responses;
+	bool bSimulatePhysics;
+};
+
+/* Profiles for an Item's components in one EItemState, a null profile leaves that component as it is */
+struct FItemStateProfile
+{
+	const FItemCollisionProfile* Mesh;
+	const FItemCollisionProfile* AreaSphere;
+	const FItemCollisionProfile* CollisionBox;
+	bool bMeshVisible;
+	bool bHidePickupWidget;
+};
+
 USTRUCT(BlueprintType)
 struct FItemRarityTable : public FTableRowBase
 {
@@ -95,6 +140,12 @@ protected:
 	// Sets properties of the Item's components based on State
 	virtual void SetItemProperties(EItemState State);
 
+	// Component profiles for State, or nullptr for EIS_MAX
+	static const FItemStateProfile* GetStateProfile(EItemState State);
+
+	// Applies only the parts of Profile that differ from Component's current settings
+	static void ApplyCollisionProfile(UPrimitiveComponent* Component, const FItemCollisionProfile& Profile);
+
 	// Called when ItemInterpTimer is finished
 	void FinishInterping();
 
@@ -110,11 +161,19 @@ protected:
 
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	// Applies the rarity data for ItemRarity, also used to reset pooled Items at runtime
+	virtual void ApplyItemData();
+
 	void EnableGlowMaterial();
 
-	void ResetPulseTimer();
+	// Puts the shared MaterialInstance on the mesh and writes the glow color and strengths as custom primitive data
+	void ApplyGlowMaterial();
+
+	// Tells the glow material which pulse to play, starting at StartTime and lasting Period seconds
+	void SetPulseData(float Mode, float StartTime, float Period);
 
-	void UpdatePulse();
+	// True while the Item has per-frame work to do, which is only while interping
+	virtual bool NeedsTick() const;
 
 public:	
 	// Called every frame
@@ -133,7 +192,11 @@ public:
 
 	void DisableGlowMaterial();
 
-	void StartPulseTimer();
+	// Starts the looping pickup pulse with a random phase so nearby Items don't pulse in sync
+	void StartPulse();
+
+	// Turns ticking on or off to match NeedsTick, call whenever something it depends on changes
+	void RefreshTickEnabled();
 
 private:
 	/* Skeletal mesh for the Item */
@@ -229,10 +292,6 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	int32 MaterialIndex;
 
-	/* Dynamic Instance that we an change at runtime */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	UMaterialInstanceDynamic* DynamicMaterialInstance;
-
 	/* Material Instance used with the Dynamic Material */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	UMaterialInstance* MaterialInstance;
@@ -240,13 +299,7 @@ private:
 	/* True when Custom Depth on Items can be enabled */
 	bool bCanChangeCustomDepth; 
 
-	/* Curve to drive the dynamic material parameters */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	UCurveVector* PulseCurve;
-
-	FTimerHandle PulseTimer;
-
-	/* Time for the Pulsetimer */
+	/* Length of one pickup pulse */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float PulseCurveTime;
 
@@ -259,9 +312,6 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float FresnelReflectFraction;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	UCurveVector* InterpPulseCurve;
-
 	/* Weapon Icon for this Item in the Inventory */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
 	UTexture2D* IconItem;
@@ -307,11 +357,11 @@ public:
 	FORCEINLINE EItemState GetItemState() const { return ItemState; }
 	FORCEINLINE FLinearColor GetGlowColor() const { return GlowColor; }
 	FORCEINLINE int32 GetItemCount() const { return ItemCount; }
+	FORCEINLINE EItemRarity GetItemRarity() const { return ItemRarity; }
 	FORCEINLINE int32 GetMaterialIndex() const { return MaterialIndex; }
 	FORCEINLINE int32 GetSlotIndex() const { return SlotIndex; }
 	FORCEINLINE UBoxComponent* GetCollisionBox() const { return CollisionBox; }
 	FORCEINLINE UMaterialInstance* GetMaterialInstance() const { return MaterialInstance; }
-	FORCEINLINE UMaterialInstanceDynamic* GetDynamicMaterialInstance() const { return DynamicMaterialInstance; }
 	FORCEINLINE USkeletalMeshComponent* GetItemMesh() const { return ItemMesh; }
 	FORCEINLINE USoundCue* GetEquipSound() const { return EquipSound; }
 	FORCEINLINE USoundCue* GetPickupSound() const { return PickupSound; }
@@ -321,9 +371,9 @@ public:
 	// Setters for private variables
 	FORCEINLINE void SetAmmoIcon(UTexture2D* Icon) { IconAmmo = Icon; }
 	FORCEINLINE void SetCharacterInventoryFull(bool bFull) { bCharacterInventoryFull = bFull; }
-	FORCEINLINE void SetDynamicMaterialInstance(UMaterialInstanceDynamic* Instance) { DynamicMaterialInstance = Instance; }
 	FORCEINLINE void SetEquipSound(USoundCue* Sound) { EquipSound = Sound; }
 	FORCEINLINE void SetInventoryIcon(UTexture2D* Icon) { IconItem = Icon; }
+	FORCEINLINE void SetItemRarity(EItemRarity Rarity) { ItemRarity = Rarity; }
 	FORCEINLINE void SetMaterialIndex(int32 Index) { MaterialIndex = Index; }
 	FORCEINLINE void SetMaterialInstance(UMaterialInstance* Instance) { MaterialInstance = Instance; }
 	FORCEINLINE void SetPickupSound(USoundCue* Sound) { PickupSound = Sound; }
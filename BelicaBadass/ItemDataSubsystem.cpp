@@ -0,0 +1,263 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemDataSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/AssetManager.h"
+#include "Engine/DataTable.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+
+namespace ItemData
+{
+	const TCHAR* RarityTablePath{ TEXT("DataTable'/Game/_Game/DataTables/ItemRarityDataTable.ItemRarityDataTable'") };
+	const TCHAR* WeaponTablePath{ TEXT("DataTable'/Game/_Game/DataTables/WeaponDataTable.WeaponDataTable'") };
+
+	/* Row names in EItemRarity order */
+	const FName RarityRowNames[]{ FName("Damaged"), FName("Common"), FName("Uncommon"), FName("Rare"), FName("Legendary") };
+	static_assert(UE_ARRAY_COUNT(RarityRowNames) == static_cast<int32>(EItemRarity::EIR_MAX), "Every item rarity needs a row name");
+
+	/* Row names in EWeaponType order */
+	const FName WeaponRowNames[]{ FName("SubmachineGun"), FName("AssaultRifle"), FName("Pistol") };
+	static_assert(UE_ARRAY_COUNT(WeaponRowNames) == static_cast<int32>(EWeaponType::EWT_MAX), "Every weapon type needs a row name");
+
+	const FPrimaryAssetType WeaponAssetType{ TEXT("Weapon") };
+	const FName WeaponBundleName{ TEXT("Game") };
+}
+
+void UItemDataSubsystem::Deinitialize()
+{
+	Invalidate();
+
+	Super::Deinitialize();
+}
+
+const FItemRarityTable* UItemDataSubsystem::GetRarityData(EItemRarity Rarity)
+{
+	if (!bRarityDataLoaded) LoadRarityData();
+
+	const int32 Index{ static_cast<int32>(Rarity) };
+	return ValidRarityRows.IsValidIndex(Index) && ValidRarityRows[Index] ? &RarityData[Index] : nullptr;
+}
+
+const FWeaponDataTable* UItemDataSubsystem::GetWeaponData(EWeaponType Type)
+{
+	if (!bWeaponDataLoaded) LoadWeaponData();
+
+	const int32 Index{ static_cast<int32>(Type) };
+	return ValidWeaponRows.IsValidIndex(Index) && ValidWeaponRows[Index] ? &WeaponData[Index] : nullptr;
+}
+
+TSharedPtr<const FWeaponDescriptor> UItemDataSubsystem::GetWeaponDescriptor(EWeaponType Type)
+{
+	const FWeaponDataTable* WeaponRow{ GetWeaponData(Type) };
+	if (WeaponRow == nullptr) return nullptr;
+
+	TSharedPtr<FWeaponDescriptor>& Descriptor{ WeaponDescriptors[static_cast<int32>(Type)] };
+	if (!Descriptor.IsValid()) Descriptor = BuildWeaponDescriptor(*WeaponRow);
+
+	return Descriptor;
+}
+
+void UItemDataSubsystem::GetWeaponRecordIcons(const FWeaponRecord& Record, UTexture2D*& InventoryIcon, UTexture2D*& AmmoIcon, UTexture2D*& IconBackground)
+{
+	const FWeaponDataTable* WeaponRow{ GetWeaponData(Record.WeaponType) };
+	InventoryIcon = WeaponRow ? ResolveWeaponAsset(WeaponRow->InventoryIcon) : nullptr;
+	AmmoIcon = WeaponRow ? ResolveWeaponAsset(WeaponRow->AmmoIcon) : nullptr;
+
+	const FItemRarityTable* RarityRow{ GetRarityData(Record.Rarity) };
+	IconBackground = RarityRow ? RarityRow->IconBackground : nullptr;
+}
+
+void UItemDataSubsystem::PreloadWeapon(EWeaponType Type, FSimpleDelegate OnLoaded)
+{
+	if (GetWeaponData(Type) == nullptr) return;
+
+	// Without an asset manager the caller falls back to loading what it needs synchronously
+	if (!UAssetManager::IsValid())
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	const int32 Index{ static_cast<int32>(Type) };
+	TSharedPtr<FStreamableHandle>& Handle{ WeaponPreloadHandles[Index] };
+	if (Handle.IsValid() && Handle->HasLoadCompleted())
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	if (OnLoaded.IsBound()) WeaponPreloadCallbacks[Index].Add(MoveTemp(OnLoaded));
+	if (Handle.IsValid()) return;
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	const FPrimaryAssetId AssetId{ ItemData::WeaponAssetType, ItemData::WeaponRowNames[Index] };
+	Handle = UAssetManager::Get().LoadPrimaryAsset(AssetId, { ItemData::WeaponBundleName },
+		FStreamableDelegate::CreateUObject(this, &UItemDataSubsystem::OnWeaponPreloaded, Index, StartTime));
+
+	// Nothing to stream, e.g. the asset isn't registered, so don't keep the callers waiting
+	if (!Handle.IsValid() && WeaponPreloadCallbacks[Index].Num() > 0) OnWeaponPreloaded(Index, StartTime);
+}
+
+void UItemDataSubsystem::Invalidate()
+{
+#if WITH_EDITOR
+	for (const TWeakObjectPtr<UDataTable>& Table : WatchedTables)
+	{
+		if (Table.IsValid()) Table->OnDataTableChanged().RemoveAll(this);
+	}
+#endif
+	WatchedTables.Empty();
+
+	for (TSharedPtr<FStreamableHandle>& Handle : WeaponPreloadHandles)
+	{
+		if (Handle.IsValid()) Handle->ReleaseHandle();
+	}
+	WeaponPreloadHandles.Empty();
+	WeaponPreloadCallbacks.Empty();
+
+	RarityData.Empty();
+	WeaponData.Empty();
+	WeaponDescriptors.Empty();
+	ValidRarityRows.Empty();
+	ValidWeaponRows.Empty();
+	bRarityDataLoaded = false;
+	bWeaponDataLoaded = false;
+}
+
+UItemDataSubsystem* UItemDataSubsystem::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UItemDataSubsystem>() : nullptr;
+}
+
+void UItemDataSubsystem::LoadRarityData()
+{
+	bRarityDataLoaded = true;
+	RarityData.SetNum(static_cast<int32>(EItemRarity::EIR_MAX));
+	ValidRarityRows.Init(false, RarityData.Num());
+
+	UDataTable* RarityTable{ LoadTable(ItemData::RarityTablePath) };
+	if (RarityTable == nullptr) return;
+
+	for (int32 i = 0; i < RarityData.Num(); i++)
+	{
+		const FItemRarityTable* Row{ RarityTable->FindRow<FItemRarityTable>(ItemData::RarityRowNames[i], TEXT("")) };
+		if (Row == nullptr) continue;
+
+		RarityData[i] = *Row;
+		ValidRarityRows[i] = true;
+	}
+}
+
+void UItemDataSubsystem::LoadWeaponData()
+{
+	bWeaponDataLoaded = true;
+	WeaponData.SetNum(static_cast<int32>(EWeaponType::EWT_MAX));
+	WeaponDescriptors.SetNum(WeaponData.Num());
+	WeaponPreloadHandles.SetNum(WeaponData.Num());
+	WeaponPreloadCallbacks.SetNum(WeaponData.Num());
+	ValidWeaponRows.Init(false, WeaponData.Num());
+
+	UDataTable* WeaponTable{ LoadTable(ItemData::WeaponTablePath) };
+	if (WeaponTable == nullptr) return;
+
+	for (int32 i = 0; i < WeaponData.Num(); i++)
+	{
+		const FWeaponDataTable* Row{ WeaponTable->FindRow<FWeaponDataTable>(ItemData::WeaponRowNames[i], TEXT("")) };
+		if (Row == nullptr) continue;
+
+		WeaponData[i] = *Row;
+		ValidWeaponRows[i] = true;
+	}
+
+	RegisterWeaponAssets();
+}
+
+void UItemDataSubsystem::RegisterWeaponAssets()
+{
+	if (!UAssetManager::IsValid()) return;
+
+	for (int32 i = 0; i < WeaponData.Num(); i++)
+	{
+		if (!ValidWeaponRows[i]) continue;
+
+		const FWeaponDataTable& Row{ WeaponData[i] };
+		TArray<FSoftObjectPath> BundleAssets{
+			Row.PickupSound.ToSoftObjectPath(), Row.EquipSound.ToSoftObjectPath(),
+			Row.ItemMesh.ToSoftObjectPath(), Row.InventoryIcon.ToSoftObjectPath(),
+			Row.AmmoIcon.ToSoftObjectPath(), Row.MaterialInstance.ToSoftObjectPath(),
+			Row.AnimationBlueprint.ToSoftObjectPath(),
+			Row.CrosshairsMiddle.ToSoftObjectPath(), Row.CrosshairsLeft.ToSoftObjectPath(),
+			Row.CrosshairsRight.ToSoftObjectPath(), Row.CrosshairsBottom.ToSoftObjectPath(),
+			Row.CrosshairsTop.ToSoftObjectPath(),
+			Row.MuzzleFlash.ToSoftObjectPath(), Row.FireSound.ToSoftObjectPath() };
+		BundleAssets.RemoveAll([](const FSoftObjectPath& Path) { return Path.IsNull(); });
+
+		FAssetBundleData BundleData;
+		BundleData.SetBundleAssets(ItemData::WeaponBundleName, MoveTemp(BundleAssets));
+
+		const FPrimaryAssetId AssetId{ ItemData::WeaponAssetType, ItemData::WeaponRowNames[i] };
+		UAssetManager::Get().AddDynamicAsset(AssetId, FSoftObjectPath(), BundleData);
+	}
+}
+
+void UItemDataSubsystem::OnWeaponPreloaded(int32 Index, double StartTime)
+{
+	const double LatencyMs{ (FPlatformTime::Seconds() - StartTime) * 1000.0 };
+	UE_LOG(LogTemp, Log, TEXT("Weapon %s preloaded in %.2f ms"), *ItemData::WeaponRowNames[Index].ToString(), LatencyMs);
+
+	if (!WeaponPreloadCallbacks.IsValidIndex(Index)) return;
+
+	if (WeaponDescriptors[Index].IsValid()) IndexWeaponMesh(*WeaponDescriptors[Index]);
+
+	// A callback may start another preload, so take the list first
+	TArray<FSimpleDelegate> Callbacks{ MoveTemp(WeaponPreloadCallbacks[Index]) };
+	WeaponPreloadCallbacks[Index].Reset();
+	for (FSimpleDelegate& Callback : Callbacks) Callback.ExecuteIfBound();
+}
+
+TSharedPtr<FWeaponDescriptor> UItemDataSubsystem::BuildWeaponDescriptor(const FWeaponDataTable& WeaponRow)
+{
+	TSharedPtr<FWeaponDescriptor> Descriptor{ MakeShared<FWeaponDescriptor>() };
+	Descriptor->Data = WeaponRow;
+	IndexWeaponMesh(*Descriptor);
+
+	return Descriptor;
+}
+
+void UItemDataSubsystem::IndexWeaponMesh(FWeaponDescriptor& Descriptor)
+{
+	// Never load the mesh here, the preload calls back in once it has streamed in
+	const USkeletalMesh* ItemMesh{ Descriptor.Data.ItemMesh.Get() };
+	if (ItemMesh == nullptr || Descriptor.IndexedMesh.Get() == ItemMesh) return;
+
+	const FReferenceSkeleton& RefSkeleton{ ItemMesh->GetRefSkeleton() };
+	Descriptor.ClipBoneIndex = RefSkeleton.FindBoneIndex(Descriptor.Data.ClipBoneName);
+
+	const USkeletalMeshSocket* BarrelSocket{ ItemMesh->FindSocket(TEXT("BarrelSocket")) };
+	Descriptor.BarrelBoneIndex = BarrelSocket ? RefSkeleton.FindBoneIndex(BarrelSocket->BoneName) : INDEX_NONE;
+	Descriptor.BarrelSocketLocalTransform = BarrelSocket ? BarrelSocket->GetSocketLocalTransform() : FTransform::Identity;
+	Descriptor.IndexedMesh = ItemMesh;
+}
+
+UDataTable* UItemDataSubsystem::LoadTable(const TCHAR* Path)
+{
+	UDataTable* Table{ Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, Path)) };
+	if (Table == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Item data table %s could not be loaded"), Path);
+		return nullptr;
+	}
+
+#if WITH_EDITOR
+	// Rebuild everything after a table edit so construction scripts pick up the new rows
+	if (!WatchedTables.Contains(Table))
+	{
+		Table->OnDataTableChanged().AddUObject(this, &UItemDataSubsystem::Invalidate);
+		WatchedTables.Add(Table);
+	}
+#endif
+
+	return Table;
+}
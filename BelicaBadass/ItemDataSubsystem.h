@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "Item.h"
+#include "Weapon.h"
+#include "ItemDataSubsystem.generated.h"
+
+/**
+ * Loads the item rarity and weapon data tables once and keeps their rows in arrays indexed by
+ * EItemRarity and EWeaponType, so construction scripts and runtime spawns get their data in O(1)
+ * without loading the tables or looking rows up by name. Rows are reloaded when a table is edited.
+ * Each weapon row is registered with the Asset Manager as a "Weapon" primary asset whose "Game"
+ * bundle holds the row's soft references, so a weapon's assets can be streamed in ahead of use.
+ */
+UCLASS()
+class BELICABADASS_API UItemDataSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Rarity data for Rarity, or nullptr when the table has no row for it
+	const FItemRarityTable* GetRarityData(EItemRarity Rarity);
+
+	// Weapon data for Type, or nullptr when the table has no row for it
+	const FWeaponDataTable* GetWeaponData(EWeaponType Type);
+
+	// Shared descriptor for every Weapon of Type, built on first use, or nullptr when the table has no row for it
+	TSharedPtr<const FWeaponDescriptor> GetWeaponDescriptor(EWeaponType Type);
+
+	// Icons the HUD shows for a Weapon kept as an inventory record
+	UFUNCTION(BlueprintPure, Category = "Item Data")
+	void GetWeaponRecordIcons(const FWeaponRecord& Record, UTexture2D*& InventoryIcon, UTexture2D*& AmmoIcon, UTexture2D*& IconBackground);
+
+	// Starts streaming in the assets of Type's bundle unless they are loading or loaded already, OnLoaded is called once they are in memory
+	void PreloadWeapon(EWeaponType Type, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+	// Drops the cached rows so they are rebuilt on the next lookup
+	void Invalidate();
+
+	static UItemDataSubsystem* Get();
+
+protected:
+	void LoadRarityData();
+
+	void LoadWeaponData();
+
+	// Copies a weapon row, the bone indices are filled in right away only if its mesh is already in memory
+	static TSharedPtr<FWeaponDescriptor> BuildWeaponDescriptor(const FWeaponDataTable& WeaponRow);
+
+	// Precomputes the bone indices used when firing and reloading, once the descriptor's mesh is loaded
+	static void IndexWeaponMesh(FWeaponDescriptor& Descriptor);
+
+	// Registers each weapon row as a primary asset with a bundle of its soft references
+	void RegisterWeaponAssets();
+
+	void OnWeaponPreloaded(int32 Index, double StartTime);
+
+	// Loads the table at Path and listens for edits to it in the editor
+	UDataTable* LoadTable(const TCHAR* Path);
+
+private:
+	/* Rarity rows indexed by EItemRarity */
+	UPROPERTY()
+	TArray<FItemRarityTable> RarityData;
+
+	/* Weapon rows indexed by EWeaponType */
+	UPROPERTY()
+	TArray<FWeaponDataTable> WeaponData;
+
+	/* Descriptors indexed by EWeaponType */
+	TArray<TSharedPtr<FWeaponDescriptor>> WeaponDescriptors;
+
+	/* True for each index of RarityData and WeaponData that came from a table row */
+	TBitArray<> ValidRarityRows;
+	TBitArray<> ValidWeaponRows;
+
+	/* Streamable handles indexed by EWeaponType, keep a preloaded weapon's assets in memory */
+	TArray<TSharedPtr<FStreamableHandle>> WeaponPreloadHandles;
+
+	/* Callers waiting for a weapon's assets, indexed by EWeaponType */
+	TArray<TArray<FSimpleDelegate>> WeaponPreloadCallbacks;
+
+	bool bRarityDataLoaded{ false };
+	bool bWeaponDataLoaded{ false };
+
+	/* Tables we listen to for edits */
+	TArray<TWeakObjectPtr<UDataTable>> WatchedTables;
+};
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ObjectPool.generated.h"
+
+/* Free list and usage counts of one pool, shared by the FX, enemy and weapon pools */
+USTRUCT()
+struct FObjectPool
+{
+	GENERATED_BODY()
+
+	/* Objects that were given back and are ready to be handed out again */
+	UPROPERTY()
+	TArray<UObject*> FreeObjects;
+
+	/* Number of objects the pool has handed out and not taken back yet */
+	int32 ActiveCount{ 0 };
+
+	/* Most objects that were handed out at the same time */
+	int32 HighWaterMark{ 0 };
+
+	// Takes the most recently freed object that is still valid off the free list, nullptr when there is none
+	template<typename T>
+	T* PopFree()
+	{
+		while (FreeObjects.Num() > 0)
+		{
+			T* Object{ Cast<T>(FreeObjects.Pop(false)) };
+			if (IsValid(Object)) return Object;
+		}
+		return nullptr;
+	}
+
+	// Keeps Object for reuse, false when MaxFree objects are already waiting and the caller should destroy it
+	bool AddFree(UObject* Object, int32 MaxFree)
+	{
+		if (FreeObjects.Num() >= MaxFree) return false;
+
+		FreeObjects.Add(Object);
+		return true;
+	}
+
+	void MarkAcquired()
+	{
+		++ActiveCount;
+		HighWaterMark = FMath::Max(HighWaterMark, ActiveCount);
+	}
+
+	// Only call this for objects the pool handed out
+	void MarkReleased()
+	{
+		ensureMsgf(ActiveCount > 0, TEXT("Object pool released more objects than it handed out"));
+		--ActiveCount;
+	}
+};
+
+namespace ObjectPool
+{
+	// Logs active, free and high-water counts of every pool in Pools
+	template<typename KeyType>
+	void DumpPoolStats(const TCHAR* PoolName, const TMap<KeyType, FObjectPool>& Pools)
+	{
+		for (const auto& PoolPair : Pools)
+		{
+			UE_LOG(LogTemp, Log, TEXT("%s pool %s: %d active, %d free, high-water %d"), PoolName, *GetNameSafe(PoolPair.Key), PoolPair.Value.ActiveCount, PoolPair.Value.FreeObjects.Num(), PoolPair.Value.HighWaterMark);
+		}
+	}
+
+	// Console command that calls DumpPoolStats on the SubsystemType of the world it runs in
+	template<typename SubsystemType>
+	FConsoleCommandWithWorldDelegate MakeDumpCommand()
+	{
+		return FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			SubsystemType* Pool{ World ? World->GetSubsystem<SubsystemType>() : nullptr };
+			if (Pool) Pool->DumpPoolStats();
+		});
+	}
+}
@@ -29,67 +29,85 @@ UShooterAnimInstance::UShooterAnimInstance() :
 
 void UShooterAnimInstance::UpdateAnimationProperties(float DeltaTime)
 {
-	if (ShooterCharacter == nullptr) ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
-
-	if (ShooterCharacter)
-	{
-		// Get the lateral speed of the character from velocity
-		FVector Velocity{ ShooterCharacter->GetVelocity() };
-		Velocity.Z = 0.f;
-		Speed = Velocity.Size();
-
-		// Is the Character in the air?
-		bIsInAir = ShooterCharacter->GetCharacterMovement()->IsFalling();
-
-		// Is the Character moving?
-		bIsMoving = ShooterCharacter->GetCharacterMovement()->GetCurrentAcceleration().Size() > 0.f;
-
-		// Is the Character aiming?
-		bAiming = ShooterCharacter->GetAiming();
-
-		// Is the Character reloading?
-		bReloading = ShooterCharacter->GetCombatState() == ECombatState::ECS_Reloading;
-
-		// Is the Character crouching?
-		bCrouching = ShooterCharacter->GetCrouching();
-
-		// Is the Character equipping a different Weapon?
-		bEquipping = ShooterCharacter->GetCombatState() == ECombatState::ECS_Equipping;
+}
 
-		// Determine which Weapon the Character has equipped
-		if (ShooterCharacter->GetEquippedWeapon()) EquippedWeaponType = ShooterCharacter->GetEquippedWeapon()->GetWeaponType();
+void UShooterAnimInstance::NativeInitializeAnimation()
+{
+	ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+}
 
-		// Calculate movement offset for straffing and backward animations
-		FRotator AimRotation{ ShooterCharacter->GetBaseAimRotation() }, MovementRotation{ UKismetMathLibrary::MakeRotFromX(ShooterCharacter->GetVelocity()) };
-		MovementOffsetYaw = UKismetMathLibrary::NormalizedDeltaRotator(MovementRotation, AimRotation).Yaw;
-		if (ShooterCharacter->GetVelocity().Size() > 0.f) LastMovementOffsetYaw = MovementOffsetYaw;
+void UShooterAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeUpdateAnimation(DeltaSeconds);
 
-		// What is the OffsetState of the Character?
-		if (bReloading) OffsetState = EOffsetState::EOS_Reloading;
-		else if (bIsInAir) OffsetState = EOffsetState::EOS_InAir;
-		else if (ShooterCharacter->GetAiming()) OffsetState = EOffsetState::EOS_Aiming;
-		else OffsetState = EOffsetState::EOS_Hip;
-	}
+	if (ShooterCharacter == nullptr) ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
 
-	TurnInPlace();
-	Lean(DeltaTime);
+	Snapshot.bValid = ShooterCharacter != nullptr;
+	if (!Snapshot.bValid) return;
+
+	// Only copy values here, everything derived from them is computed on a worker thread
+	const UCharacterMovementComponent* Movement{ ShooterCharacter->GetCharacterMovement() };
+	Snapshot.Velocity = ShooterCharacter->GetVelocity();
+	Snapshot.bFalling = Movement->IsFalling();
+	Snapshot.bAccelerating = Movement->GetCurrentAcceleration().Size() > 0.f;
+	Snapshot.bAiming = ShooterCharacter->GetAiming();
+	Snapshot.bCrouching = ShooterCharacter->GetCrouching();
+	Snapshot.bReloading = ShooterCharacter->GetCombatState() == ECombatState::ECS_Reloading;
+	Snapshot.bEquipping = ShooterCharacter->GetCombatState() == ECombatState::ECS_Equipping;
+	Snapshot.bHasWeapon = ShooterCharacter->GetEquippedWeapon() != nullptr;
+	if (Snapshot.bHasWeapon) Snapshot.EquippedWeaponType = ShooterCharacter->GetEquippedWeapon()->GetWeaponType();
+	Snapshot.AimRotation = ShooterCharacter->GetBaseAimRotation();
+	Snapshot.ActorRotation = ShooterCharacter->GetActorRotation();
+
+	// Curves from the last evaluation, read here since the curve cache belongs to the game thread
+	Snapshot.TurningCurve = GetCurveValue(TEXT("Turning"));
+	Snapshot.RotationCurve = GetCurveValue(TEXT("Rotation"));
 }
 
-void UShooterAnimInstance::NativeInitializeAnimation()
+void UShooterAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
 {
-	ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	if (!Snapshot.bValid) return;
+
+	// Get the lateral speed of the character from velocity
+	FVector Velocity{ Snapshot.Velocity };
+	Velocity.Z = 0.f;
+	Speed = Velocity.Size();
+
+	bIsInAir = Snapshot.bFalling;
+	bIsMoving = Snapshot.bAccelerating;
+	bAiming = Snapshot.bAiming;
+	bReloading = Snapshot.bReloading;
+	bCrouching = Snapshot.bCrouching;
+	bEquipping = Snapshot.bEquipping;
+	if (Snapshot.bHasWeapon) EquippedWeaponType = Snapshot.EquippedWeaponType;
+
+	// Calculate movement offset for straffing and backward animations
+	const FRotator MovementRotation{ UKismetMathLibrary::MakeRotFromX(Snapshot.Velocity) };
+	MovementOffsetYaw = UKismetMathLibrary::NormalizedDeltaRotator(MovementRotation, Snapshot.AimRotation).Yaw;
+	if (Snapshot.Velocity.Size() > 0.f) LastMovementOffsetYaw = MovementOffsetYaw;
+
+	// What is the OffsetState of the Character?
+	if (bReloading) OffsetState = EOffsetState::EOS_Reloading;
+	else if (bIsInAir) OffsetState = EOffsetState::EOS_InAir;
+	else if (bAiming) OffsetState = EOffsetState::EOS_Aiming;
+	else OffsetState = EOffsetState::EOS_Hip;
+
+	TurnInPlace();
+	Lean(DeltaSeconds);
 }
 
 void UShooterAnimInstance::TurnInPlace()
 {
-	if (ShooterCharacter == nullptr) return;
+	if (!Snapshot.bValid) return;
 
-	Pitch = ShooterCharacter->GetBaseAimRotation().Pitch;
+	Pitch = Snapshot.AimRotation.Pitch;
 
 	if (Speed > 0 || bIsInAir)
 	{
 		RootYawOffset = 0.f;
-		TIP_CharacterYaw = ShooterCharacter->GetActorRotation().Yaw;
+		TIP_CharacterYaw = Snapshot.ActorRotation.Yaw;
 		TIP_CharacterYawLastFrame = TIP_CharacterYaw;
 		RotationCuveLastFame = 0.f;
 		RotationCurve = 0.f;
@@ -97,18 +115,17 @@ void UShooterAnimInstance::TurnInPlace()
 	else
 	{
 		TIP_CharacterYawLastFrame = TIP_CharacterYaw;
-		TIP_CharacterYaw = ShooterCharacter->GetActorRotation().Yaw;
+		TIP_CharacterYaw = Snapshot.ActorRotation.Yaw;
 		const float TIP_YawDelta{ TIP_CharacterYaw - TIP_CharacterYawLastFrame };
 
 		// Root Yaw Offset, clamped between -180 and 180
 		RootYawOffset = UKismetMathLibrary::NormalizeAxis(RootYawOffset - TIP_YawDelta);
 
-		const float Turning{ GetCurveValue(TEXT("Turning")) };
-		if (Turning > 0)
+		if (Snapshot.TurningCurve > 0)
 		{
 			bTurningInPlace = true;
 			RotationCuveLastFame = RotationCurve;
-			RotationCurve = GetCurveValue(TEXT("Rotation"));
+			RotationCurve = Snapshot.RotationCurve;
 			const float DeltaRotation{ RotationCurve - RotationCuveLastFame };
 			// RootYawOffset positive we are turning left, negative we ar turning right
 			(RootYawOffset > 0) ? RootYawOffset -= DeltaRotation : RootYawOffset += DeltaRotation;
@@ -142,10 +159,10 @@ void UShooterAnimInstance::TurnInPlace()
 
 void UShooterAnimInstance::Lean(float DeltaTime)
 {
-	if (ShooterCharacter == nullptr) return;
+	if (!Snapshot.bValid || DeltaTime <= 0.f) return;
 
 	CharacterRotationLastFrame = CharacterRotation;
-	CharacterRotation = ShooterCharacter->GetActorRotation();
+	CharacterRotation = Snapshot.ActorRotation;
 	const FRotator Delta{ UKismetMathLibrary::NormalizedDeltaRotator(CharacterRotation, CharacterRotationLastFrame) };
 
 	const float Target = Delta.Yaw / DeltaTime, Interp = FMath::FInterpTo(YawDelta, Target, DeltaTime, 6.f);
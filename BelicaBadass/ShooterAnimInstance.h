@@ -17,6 +17,25 @@ enum class EOffsetState : uint8
 	EOS_MAX UMETA(DisplayName = "DefaultMax")
 };
 
+/* Everything the animation update needs from the Character, copied on the game thread each frame */
+struct FShooterAnimSnapshot
+{
+	FVector Velocity{ FVector::ZeroVector };
+	FRotator AimRotation{ FRotator::ZeroRotator };
+	FRotator ActorRotation{ FRotator::ZeroRotator };
+	EWeaponType EquippedWeaponType{ EWeaponType::EWT_MAX };
+	float TurningCurve{ 0.f };
+	float RotationCurve{ 0.f };
+	bool bValid{ false };
+	bool bAccelerating{ false };
+	bool bFalling{ false };
+	bool bAiming{ false };
+	bool bCrouching{ false };
+	bool bReloading{ false };
+	bool bEquipping{ false };
+	bool bHasWeapon{ false };
+};
+
 UCLASS()
 class BELICABADASS_API UShooterAnimInstance : public UAnimInstance
 {
@@ -25,11 +44,18 @@ class BELICABADASS_API UShooterAnimInstance : public UAnimInstance
 public:
 	UShooterAnimInstance();
 
-	UFUNCTION(BlueprintCallable)
+	// No longer does any work, the update runs in NativeThreadSafeUpdateAnimation; kept so existing graphs still compile
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Animation properties are now updated natively, remove this call from the event graph."))
 	void UpdateAnimationProperties(float DeltaTime);
 
 	virtual void NativeInitializeAnimation() override;
 
+	// Copies the Character's state into Snapshot on the game thread
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+
+	// Computes every animation property from Snapshot on a worker thread
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
 protected:
 	// Handle turning in place variables
 	void TurnInPlace();
@@ -38,6 +64,9 @@ protected:
 	void Lean(float DeltaTime);
 
 private:
+	/* Character state for this frame, only read off the game thread */
+	FShooterAnimSnapshot Snapshot;
+
 	/* Get a referenc the ShooterCharacter */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
 	class AShooterCharacter* ShooterCharacter;
@@ -22,6 +22,35 @@
 #include "Enemy.h"
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "FXPoolSubsystem.h"
+#include "WeaponPoolSubsystem.h"
+#include "InventoryComponent.h"
+#include "SurfaceEffectsDataAsset.h"
+#include "ImpactDecalSubsystem.h"
+#include "HitscanSubsystem.h"
+
+static TAutoConsoleVariable<int32> CVarAsyncItemTrace(
+	TEXT("Belica.AsyncItemTrace"),
+	0,
+	TEXT("When 1, items under the crosshairs are found with an async trace consumed on the next frame instead of a synchronous trace every tick."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAutoFireMaxShotsPerFrame(
+	TEXT("Belica.AutoFire.MaxShotsPerFrame"),
+	8,
+	TEXT("Most automatic fire shots resolved in a single frame, shots beyond it are dropped instead of piling up after a hitch."),
+	ECVF_Default);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crosshair Trace Requests"), STAT_CrosshairTraceRequests, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crosshair Traces Issued"), STAT_CrosshairTracesIssued, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon Traces Issued"), STAT_WeaponTracesIssued, STATGROUP_BelicaBadass);
+
+namespace ShooterInput
+{
+	/* Input actions for selecting slots, in slot order; slots past these use SelectSlot<Index> */
+	const FName SlotActionNames[]{ FName("FKey"), FName("OneKey"), FName("TwoKey"), FName("ThreeKey"), FName("FourKey"), FName("FiveKey") };
+}
 
 // Sets default values
 AShooterCharacter::AShooterCharacter() :
@@ -40,12 +69,18 @@ AShooterCharacter::AShooterCharacter() :
 	CrosshairInAirFactor(0.f),
 	CrosshairAimFactor(0.f),
 	CrosshairShootingFactor(0.f),
+	// Footstep surface cache
+	CachedFloorSurface(SurfaceType_Default),
 	// Bullet fire variables
+	FXPrewarmCount(8),
 	ShootTimeDuration(0.05f),
 	bFiringBullet(false),
 	// Automatic gun fire variables
 	bShouldFire(true),
 	bFireButtonPressed(false),
+	AutoFireAccumulator(0.f),
+	LastCrosshairStart(FVector::ZeroVector),
+	LastCrosshairDirection(FVector::ForwardVector),
 	// Item trace variables
 	bShouldTraceForItems(false),
 	// Camera interp location variables
@@ -116,6 +151,8 @@ AShooterCharacter::AShooterCharacter() :
 
 	WeaponInterpComp = CreateDefaultSubobject<USceneComponent>(TEXT("Weapon Interp Comp"));
 	WeaponInterpComp->SetupAttachment(FollowCamera);
+
+	Inventory = CreateDefaultSubobject<UInventoryComponent>(TEXT("Inventory"));
 }
 
 float AShooterCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -141,12 +178,14 @@ void AShooterCharacter::BeginPlay()
 	SetDefaultCameraView();
 
 	EquipWeapon(SpawnDefaultWeapon());
-	Inventory.Add(EquippedWeapon);
-	EquippedWeapon->SetSlotIndex(0);
+	EquippedWeapon->SetSlotIndex(Inventory->AddWeapon(EquippedWeapon->MakeRecord()));
+	Inventory->SetHeldSlot(EquippedWeapon->GetSlotIndex());
 	EquippedWeapon->DisableCustomDepth();
 	EquippedWeapon->DisableGlowMaterial();
 
-	InitializeAmmoMap();
+	PrewarmFiringFX();
+
+	InitializeAmmo();
 
 	GetCharacterMovement()->MaxWalkSpeed = BaseMovementSpeed;
 
@@ -162,6 +201,20 @@ void AShooterCharacter::SetDefaultCameraView()
 	}
 }
 
+void AShooterCharacter::PrewarmFiringFX()
+{
+	UFXPoolSubsystem* FXPool{ GetWorld()->GetSubsystem<UFXPoolSubsystem>() };
+	if (FXPool == nullptr) return;
+
+	FXPool->Prewarm(ImpactParticles, FXPrewarmCount);
+	if (SurfaceEffects)
+	{
+		for (const FSurfaceEffect& Effect : SurfaceEffects->GetEffects()) FXPool->Prewarm(Effect.ImpactParticles, FXPrewarmCount);
+	}
+	FXPool->Prewarm(BeamParticles, FXPrewarmCount);
+	if (EquippedWeapon) FXPool->Prewarm(EquippedWeapon->GetMuzzleFlash(), FXPrewarmCount);
+}
+
 void AShooterCharacter::MoveForward(float Value)
 {
 	if (Controller && Value)
@@ -201,20 +254,35 @@ void AShooterCharacter::FireWeapon()
 
 	if (WeaponHasAmmo())
 	{
-		if (EquippedWeapon->GetFireSound()) UGameplayStatics::PlaySound2D(this, EquippedWeapon->GetFireSound());
+		FBulletShot Shot;
+		Shot.Timestamp = GetWorld()->GetTimeSeconds();
+		Shot.bCurrentAim = true;
+		if (GetCrosshairTraceSegment(UGameplayStatics::GetPlayerController(this, 0), Shot.CrosshairStart, Shot.CrosshairEnd))
+		{
+			LastCrosshairStart = Shot.CrosshairStart;
+			LastCrosshairDirection = (Shot.CrosshairEnd - Shot.CrosshairStart).GetSafeNormal();
+		}
+
+		FireShots(MakeArrayView(&Shot, 1));
+
+		StartAutoFire();
+	}
+}
 
-		SendBullet();
+void AShooterCharacter::FireShots(TArrayView<const FBulletShot> Shots)
+{
+	// Shots landing in the same frame share one sound and montage
+	if (EquippedWeapon->GetFireSound()) UGameplayStatics::PlaySound2D(this, EquippedWeapon->GetFireSound());
 
-		PlayGunFireMontage();
+	SendBullets(Shots);
 
-		EquippedWeapon->DecrementAmmo();
+	PlayGunFireMontage();
 
-		StartFireButtonTimer();
+	for (int32 i = 0; i < Shots.Num(); i++) EquippedWeapon->DecrementAmmo();
 
-		StartCrosshairBulletFire();
+	StartCrosshairBulletFire();
 
-		if (EquippedWeapon->GetWeaponType() == EWeaponType::EWT_Pistol) EquippedWeapon->StartSlideTimer();
-	}
+	if (EquippedWeapon->GetWeaponType() == EWeaponType::EWT_Pistol) EquippedWeapon->StartSlideTimer();
 }
 
 void AShooterCharacter::PlayGunFireMontage()
@@ -227,62 +295,119 @@ void AShooterCharacter::PlayGunFireMontage()
 	}
 }
 
-void AShooterCharacter::SendBullet()
+void AShooterCharacter::SendBullets(TArrayView<const FBulletShot> Shots)
 {
-	const USkeletalMeshSocket* BarrelSocket{ EquippedWeapon->GetItemMesh()->GetSocketByName("BarrelSocket") };
-	if (BarrelSocket)
+	FTransform SocketTransform;
+	if (!EquippedWeapon->GetBarrelSocketTransform(SocketTransform)) return;
+
+	if (EquippedWeapon->GetMuzzleFlash()) UFXPoolSubsystem::SpawnEmitterAtLocation(this, EquippedWeapon->GetMuzzleFlash(), SocketTransform);
+
+	UHitscanSubsystem* Hitscan{ UHitscanSubsystem::IsEnabled() ? GetWorld()->GetSubsystem<UHitscanSubsystem>() : nullptr };
+	if (Hitscan)
 	{
-		const FTransform SocketTransform{ BarrelSocket->GetSocketTransform(EquippedWeapon->GetItemMesh()) };
-		if (EquippedWeapon->GetMuzzleFlash()) UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), EquippedWeapon->GetMuzzleFlash(), SocketTransform);
+		QueueBullets(Hitscan, SocketTransform, Shots);
+		return;
+	}
+
+	// Run every trace of the frame back to back before any damage or FX is applied
+	TArray<FHitResult, TInlineAllocator<8>> BeamHitResults;
+	BeamHitResults.SetNum(Shots.Num());
+	for (int32 i = 0; i < Shots.Num(); i++) GetBeamEndLocation(SocketTransform.GetLocation(), Shots[i], BeamHitResults[i]);
+
+	for (const FHitResult& BeamHitResult : BeamHitResults) ResolveBulletHit(BeamHitResult, SocketTransform, EquippedWeapon->GetDamage(), EquippedWeapon->GetHeadShotDamage());
+}
+
+void AShooterCharacter::QueueBullets(UHitscanSubsystem* Hitscan, const FTransform& SocketTransform, TArrayView<const FBulletShot> Shots)
+{
+	const FCollisionQueryParams QueryParams{ GetWeaponTraceParams() };
+	const FVector MuzzleSocketLocation{ SocketTransform.GetLocation() };
+	const float Damage{ EquippedWeapon->GetDamage() }, HeadShotDamage{ EquippedWeapon->GetHeadShotDamage() };
+	for (const FBulletShot& Shot : Shots)
+	{
+		// Only this frame's shared crosshair trace runs on the game thread, the barrel traces all go async
+		const FVector WeaponTraceEnd{ GetWeaponTraceEnd(MuzzleSocketLocation, GetShotAimLocation(Shot, true)) };
+		INC_DWORD_STAT(STAT_WeaponTracesIssued);
+		Hitscan->QueueTrace(MuzzleSocketLocation, WeaponTraceEnd, ECC_Visibility, QueryParams, Shot.Timestamp, FOnHitscanResolved::CreateUObject(this, &AShooterCharacter::ResolveBulletHit, SocketTransform, Damage, HeadShotDamage));
+	}
+}
 
-		FHitResult BeamHitResult;
-		bool bBeamEnd = GetBeamEndLocation(SocketTransform.GetLocation(), BeamHitResult);
-		if (bBeamEnd)
+void AShooterCharacter::ResolveBulletHit(const FHitResult& BeamHitResult, const FTransform& SocketTransform, float Damage, float HeadShotDamage)
+{
+	// Async hits arrive a frame later, the damage comes with the shot so a Weapon swapped in since doesn't change it
+	if (!BeamHitResult.bBlockingHit) return;
+
+	if (BeamHitResult.GetActor())
+	{
+		// Does hit Actor implement BulletHitInterface?
+		IBulletHitInterface* BulletHitInterface = Cast<IBulletHitInterface>(BeamHitResult.GetActor());
+		if (BulletHitInterface) BulletHitInterface->BulletHit_Implementation(BeamHitResult, this, GetController());
+		else SpawnImpactEffects(BeamHitResult);
+
+		// Is the hit Actor an Enemy?
+		AEnemy* HitEnemy = Cast<AEnemy>(BeamHitResult.GetActor());
+		if (HitEnemy)
 		{
-			if (BeamHitResult.GetActor())
-			{
-				// Does hit Actor implement BulletHitInterface?
-				IBulletHitInterface* BulletHitInterface = Cast<IBulletHitInterface>(BeamHitResult.GetActor());
-				if (BulletHitInterface) BulletHitInterface->BulletHit_Implementation(BeamHitResult, this, GetController());
-				else if (ImpactParticles) UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, BeamHitResult.Location);
-
-				// Is the hit Actor an Enemy?
-				AEnemy* HitEnemy = Cast<AEnemy>(BeamHitResult.GetActor());
-				if (HitEnemy)
-				{
-					int32 Damage{};
-					if (BeamHitResult.BoneName.ToString() == HitEnemy->GetHeadBone())
-					{
-						Damage = EquippedWeapon->GetHeadShotDamage();
-						UGameplayStatics::ApplyDamage(BeamHitResult.GetActor(), Damage, GetController(), this, UDamageType::StaticClass());
-						HitEnemy->ShowHitNumber(Damage, BeamHitResult.Location, true);
-					}
-					else
-					{
-						Damage = EquippedWeapon->GetDamage();
-						UGameplayStatics::ApplyDamage(BeamHitResult.GetActor(), Damage, GetController(), this, UDamageType::StaticClass());
-						HitEnemy->ShowHitNumber(Damage, BeamHitResult.Location, false);
-					}
-				}
-			}
-
-			UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), BeamParticles, SocketTransform);
-			if (Beam) Beam->SetVectorParameter(FName("Target"), BeamHitResult.Location);
+			const FHitZoneInfo& HitZone{ HitEnemy->ResolveHitZone(BeamHitResult) };
+			// Head hits take the Weapon's HeadShotDamage as is, the zone multiplier only scales the other zones
+			const int32 ZoneDamage{ FMath::TruncToInt(HitZone.Zone == EHitZone::EHZ_Head ? HeadShotDamage : Damage * HitZone.DamageMultiplier) };
+			const FVector ShotDirection{ (BeamHitResult.TraceEnd - BeamHitResult.TraceStart).GetSafeNormal() };
+			HitEnemy->TakeDamage(ZoneDamage, FHitZoneDamageEvent(ZoneDamage, BeamHitResult, ShotDirection, UDamageType::StaticClass(), HitZone.Zone), GetController(), this);
 		}
 	}
+
+	UParticleSystemComponent* Beam = UFXPoolSubsystem::SpawnEmitterAtLocation(this, BeamParticles, SocketTransform);
+	if (Beam) Beam->SetVectorParameter(FName("Target"), BeamHitResult.Location);
 }
 
-bool AShooterCharacter::GetBeamEndLocation(const FVector& MuzzleSocketLocation, FHitResult& OutHitResult)
+FVector AShooterCharacter::GetShotAimLocation(const FBulletShot& Shot, bool bUseFrameAimDepth)
 {
-	FVector OutBeamLocation;
-	// Check for crosshair trace hit
 	FHitResult CrosshairHitResult;
-	bool bCrosshairHit = TraceUnderCrosshairs(CrosshairHitResult, OutBeamLocation);
-	if (bCrosshairHit) OutBeamLocation = CrosshairHitResult.Location;
+	FVector AimLocation{ Shot.CrosshairEnd };
+
+	// This frame's crosshair trace is shared with item tracing
+	if (Shot.bCurrentAim)
+	{
+		TraceUnderCrosshairs(CrosshairHitResult, AimLocation);
+		return AimLocation;
+	}
+
+	// Aim as deep along Shot's own ray as this frame's crosshairs hit
+	if (bUseFrameAimDepth)
+	{
+		FVector FrameAimLocation;
+		if (TraceUnderCrosshairs(CrosshairHitResult, FrameAimLocation)) AimLocation = Shot.CrosshairStart + (Shot.CrosshairEnd - Shot.CrosshairStart).GetSafeNormal() * FVector::Dist(Shot.CrosshairStart, FrameAimLocation);
+		return AimLocation;
+	}
+
+	// Shots aimed between frames can't use this frame's cached trace
+	INC_DWORD_STAT(STAT_CrosshairTracesIssued);
+	if (GetWorld()->LineTraceSingleByChannel(CrosshairHitResult, Shot.CrosshairStart, Shot.CrosshairEnd, ECC_Visibility)) AimLocation = CrosshairHitResult.Location;
+	return AimLocation;
+}
+
+FCollisionQueryParams AShooterCharacter::GetWeaponTraceParams()
+{
+	// Ask for the physical material so the impact effects can be picked by surface without another lookup
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponTrace));
+	QueryParams.bReturnPhysicalMaterial = true;
+	return QueryParams;
+}
+
+FVector AShooterCharacter::GetWeaponTraceEnd(const FVector& MuzzleSocketLocation, const FVector& AimLocation)
+{
+	// Trace a bit past the aim point so the surface it is on gets hit
+	return MuzzleSocketLocation + (AimLocation - MuzzleSocketLocation) * 1.25f;
+}
+
+bool AShooterCharacter::GetBeamEndLocation(const FVector& MuzzleSocketLocation, const FBulletShot& Shot, FHitResult& OutHitResult)
+{
+	// Check for crosshair trace hit
+	const FVector OutBeamLocation{ GetShotAimLocation(Shot, false) };
 
 	// Perform a second trace, this time from the gun barrel
-	const FVector WeaponTraceStart{ MuzzleSocketLocation }, StartToEnd{ OutBeamLocation - MuzzleSocketLocation }, WeaponTraceEnd{ MuzzleSocketLocation + StartToEnd * 1.25f };
-	GetWorld()->LineTraceSingleByChannel(OutHitResult, WeaponTraceStart, WeaponTraceEnd, ECC_Visibility);
+	const FVector WeaponTraceStart{ MuzzleSocketLocation }, WeaponTraceEnd{ GetWeaponTraceEnd(MuzzleSocketLocation, OutBeamLocation) };
+	INC_DWORD_STAT(STAT_WeaponTracesIssued);
+	GetWorld()->LineTraceSingleByChannel(OutHitResult, WeaponTraceStart, WeaponTraceEnd, ECC_Visibility, GetWeaponTraceParams());
 	if (!OutHitResult.bBlockingHit)
 	{
 		OutHitResult.Location = OutBeamLocation;
@@ -291,6 +416,28 @@ bool AShooterCharacter::GetBeamEndLocation(const FVector& MuzzleSocketLocation,
 	return true;
 }
 
+void AShooterCharacter::SpawnImpactEffects(const FHitResult& HitResult)
+{
+	if (SurfaceEffects == nullptr)
+	{
+		if (ImpactParticles) UFXPoolSubsystem::SpawnEmitterAtLocation(this, ImpactParticles, HitResult.Location);
+		return;
+	}
+
+	const FSurfaceEffect& Effect{ SurfaceEffects->GetEffect(UPhysicalMaterial::DetermineSurfaceType(HitResult.PhysMaterial.Get())) };
+
+	UParticleSystem* Particles{ Effect.ImpactParticles ? Effect.ImpactParticles : ImpactParticles };
+	if (Particles) UFXPoolSubsystem::SpawnEmitterAtLocation(this, Particles, HitResult.Location);
+	if (Effect.ImpactSound) UGameplayStatics::PlaySoundAtLocation(this, Effect.ImpactSound, HitResult.ImpactPoint);
+	if (Effect.ImpactDecal)
+	{
+		// Decals project along their X axis, spin them around it so repeated hits don't look stamped
+		FRotator DecalRotation{ HitResult.ImpactNormal.Rotation() };
+		DecalRotation.Roll = FMath::FRandRange(-180.f, 180.f);
+		UImpactDecalSubsystem::SpawnDecalAtLocation(this, Effect.ImpactDecal, Effect.ImpactDecalSize, HitResult.ImpactPoint, DecalRotation, Effect.ImpactDecalLifeSpan, Effect.ImpactDecalFadeDuration);
+	}
+}
+
 void AShooterCharacter::AimingButtonPressed()
 {
 	bAimingButtonPressed = true;
@@ -312,6 +459,8 @@ void AShooterCharacter::Tick(float DeltaTime)
 
 	CalculateCrosshairSpread(DeltaTime);
 
+	UpdateAutoFire(DeltaTime);
+
 	TraceForItems();
 
 	InterpCapsuleHalfHeight(DeltaTime);
@@ -321,41 +470,16 @@ void AShooterCharacter::TraceForItems()
 {
 	if (bShouldTraceForItems)
 	{
+		if (CVarAsyncItemTrace.GetValueOnGameThread() > 0)
+		{
+			TraceForItemsAsync();
+			return;
+		}
+
 		FHitResult ItemTraceResult;
 		FVector HitLocation;
 		TraceUnderCrosshairs(ItemTraceResult, HitLocation);
-		if (ItemTraceResult.bBlockingHit)
-		{
-			TraceHitItem = Cast<AItem>(ItemTraceResult.GetActor());
-
-			const auto TraceHitWeapon = Cast<AWeapon>(TraceHitItem);
-			if (TraceHitWeapon)
-			{
-				if (HighlightedSlot == -1) HighlightInventorySlot();
-			}
-			else if (HighlightedSlot != -1) UnHighlightInventorySlot();
-
-			if (TraceHitItem && TraceHitItem->GetItemState() == EItemState::EIS_EquipInterping) TraceHitItem = nullptr;
-
-			if (TraceHitItem && TraceHitItem->GetPickupWidget())
-			{
-				TraceHitItem->GetPickupWidget()->SetVisibility(true);
-				TraceHitItem->EnableCustomDepth();
-
-				(Inventory.Num() >= INVENTORY_CAPACITY) ? TraceHitItem->SetCharacterInventoryFull(true) : TraceHitItem->SetCharacterInventoryFull(false);
-			}
-
-			if (TraceHitItemLastFrame)
-			{
-				if (TraceHitItem != TraceHitItemLastFrame)
-				{
-					TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
-					TraceHitItemLastFrame->DisableCustomDepth();
-				}
-			}
-
-			TraceHitItemLastFrame = TraceHitItem;
-		}
+		if (ItemTraceResult.bBlockingHit) UpdateTraceHitItem(ItemTraceResult);
 	}
 	else if (TraceHitItemLastFrame)
 	{
@@ -364,6 +488,57 @@ void AShooterCharacter::TraceForItems()
 	}
 }
 
+void AShooterCharacter::TraceForItemsAsync()
+{
+	// Results of last frame's trace are only available for one frame
+	FTraceDatum ItemTraceData;
+	if (ItemTraceHandle.IsValid() && GetWorld()->QueryTraceData(ItemTraceHandle, ItemTraceData))
+	{
+		const FHitResult* ItemTraceResult{ FHitResult::GetFirstBlockingHit(ItemTraceData.OutHits) };
+		if (ItemTraceResult) UpdateTraceHitItem(*ItemTraceResult);
+	}
+
+	FVector Start, End;
+	if (GetCrosshairTraceSegment(UGameplayStatics::GetPlayerController(this, 0), Start, End)) ItemTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECC_Visibility);
+	else ItemTraceHandle = FTraceHandle();
+}
+
+void AShooterCharacter::UpdateTraceHitItem(const FHitResult& ItemTraceResult)
+{
+	TraceHitItem = Cast<AItem>(ItemTraceResult.GetActor());
+
+	const auto TraceHitWeapon = Cast<AWeapon>(TraceHitItem);
+	if (TraceHitWeapon)
+	{
+		if (HighlightedSlot == -1) HighlightInventorySlot();
+
+		// Looking at a Weapon is the earliest hint it is about to be equipped
+		TraceHitWeapon->PreloadAssets();
+	}
+	else if (HighlightedSlot != -1) UnHighlightInventorySlot();
+
+	if (TraceHitItem && TraceHitItem->GetItemState() == EItemState::EIS_EquipInterping) TraceHitItem = nullptr;
+
+	if (TraceHitItem && TraceHitItem->GetPickupWidget())
+	{
+		TraceHitItem->GetPickupWidget()->SetVisibility(true);
+		TraceHitItem->EnableCustomDepth();
+
+		TraceHitItem->SetCharacterInventoryFull(Inventory->IsFull());
+	}
+
+	if (TraceHitItemLastFrame)
+	{
+		if (TraceHitItem != TraceHitItemLastFrame)
+		{
+			TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
+			TraceHitItemLastFrame->DisableCustomDepth();
+		}
+	}
+
+	TraceHitItemLastFrame = TraceHitItem;
+}
+
 AWeapon* AShooterCharacter::SpawnDefaultWeapon()
 {
 	// Check the TSubclassOf variable and spawn the Weapon
@@ -387,6 +562,9 @@ void AShooterCharacter::EquipWeapon(AWeapon* WeaponToEquip, bool bSwapping)
 		// Set the Weapon that's spawned as the DeFaultWeapon
 		EquippedWeapon = WeaponToEquip;
 		EquippedWeapon->SetItemState(EItemState::EIS_Equipped);
+
+		// The equipped Weapon's record is stale while it's out, keep pickups from stacking onto its slot
+		Inventory->SetHeldSlot(EquippedWeapon->GetSlotIndex());
 	}
 }
 
@@ -414,10 +592,10 @@ void AShooterCharacter::EquipButtonPressed()
 
 void AShooterCharacter::SwapWeapon(AWeapon* WeaponToSwap)
 {
-	if (Inventory.Num() - 1 >= EquippedWeapon->GetSlotIndex())
+	if (Inventory->IsSlotOccupied(EquippedWeapon->GetSlotIndex()))
 	{
-		Inventory[EquippedWeapon->GetSlotIndex()] = WeaponToSwap;
 		WeaponToSwap->SetSlotIndex(EquippedWeapon->GetSlotIndex());
+		Inventory->SetSlot(EquippedWeapon->GetSlotIndex(), WeaponToSwap->MakeRecord());
 	}
 
 	DropWeapon();
@@ -426,10 +604,23 @@ void AShooterCharacter::SwapWeapon(AWeapon* WeaponToSwap)
 	TraceHitItemLastFrame = nullptr;
 }
 
-void AShooterCharacter::InitializeAmmoMap()
+AWeapon* AShooterCharacter::AcquireInventoryWeapon(const FWeaponRecord& Record)
+{
+	UWeaponPoolSubsystem* WeaponPool{ GetWorld()->GetSubsystem<UWeaponPoolSubsystem>() };
+	return WeaponPool ? WeaponPool->AcquireWeapon(Record, GetActorTransform()) : nullptr;
+}
+
+void AShooterCharacter::ReleaseInventoryWeapon(AWeapon* Weapon)
+{
+	UWeaponPoolSubsystem* WeaponPool{ GetWorld()->GetSubsystem<UWeaponPoolSubsystem>() };
+	if (WeaponPool) WeaponPool->ReleaseWeapon(Weapon);
+	else Weapon->Destroy();
+}
+
+void AShooterCharacter::InitializeAmmo()
 {
-	AmmoMap.Add(EAmmoType::EAT_9mm, Starting9mmAmmo);
-	AmmoMap.Add(EAmmoType::EAT_AR, StartingARAmmo);
+	Inventory->AddAmmo(EAmmoType::EAT_9mm, Starting9mmAmmo);
+	Inventory->AddAmmo(EAmmoType::EAT_AR, StartingARAmmo);
 }
 
 bool AShooterCharacter::WeaponHasAmmo()
@@ -472,33 +663,16 @@ void AShooterCharacter::FinishReloading()
 	if (bAimingButtonPressed) TakeAim();
 	if (EquippedWeapon == nullptr) return;
 
-	const auto AmmoType{ EquippedWeapon->GetAmmoType() };
-	if (AmmoMap.Contains(AmmoType))
-	{	
-		int32 CarriedAmmo = AmmoMap[AmmoType];
-		const int32 MagEmptySpace = EquippedWeapon->GetMagazineCapacity() - EquippedWeapon->GetAmmo();
-		if (MagEmptySpace > CarriedAmmo)
-		{
-			EquippedWeapon->ReloadAmmo(CarriedAmmo);
-			CarriedAmmo = 0;
-		}
-		else
-		{
-			EquippedWeapon->ReloadAmmo(MagEmptySpace);
-			CarriedAmmo -= MagEmptySpace;
-		}
-		AmmoMap.Add(AmmoType, CarriedAmmo);
-	}
+	// Take as much carried Ammo as the magazine has room for
+	const int32 MagEmptySpace = EquippedWeapon->GetMagazineCapacity() - EquippedWeapon->GetAmmo();
+	EquippedWeapon->ReloadAmmo(Inventory->TakeAmmo(EquippedWeapon->GetAmmoType(), MagEmptySpace));
 }
 
 bool AShooterCharacter::CarryingAmmo()
 {
 	if (EquippedWeapon == nullptr) return false;
 
-	auto AmmoType = EquippedWeapon->GetAmmoType();
-	if (AmmoMap.Contains(AmmoType)) return AmmoMap[AmmoType] > 0;
-
-	return false;
+	return Inventory->GetAmmo(EquippedWeapon->GetAmmoType()) > 0;
 }
 
 void AShooterCharacter::GrabClip()
@@ -506,8 +680,7 @@ void AShooterCharacter::GrabClip()
 	if (EquippedWeapon == nullptr) return;
 	if (HandSceneComponent == nullptr) return;
 
-	int32 ClipBoneIndex = EquippedWeapon->GetItemMesh()->GetBoneIndex(EquippedWeapon->GetClipBoneName());
-	ClipTransform = EquippedWeapon->GetItemMesh()->GetBoneTransform(ClipBoneIndex);
+	ClipTransform = EquippedWeapon->GetClipBoneTransform();
 	FAttachmentTransformRules AttachmentRules(EAttachmentRule::KeepRelative, true);
 	HandSceneComponent->AttachToComponent(GetMesh(), AttachmentRules, FName(TEXT("hand_l")));
 	HandSceneComponent->SetWorldTransform(ClipTransform);
@@ -563,13 +736,7 @@ void AShooterCharacter::StopAiming()
 
 void AShooterCharacter::PickupAmmo(AAmmo* Ammo)
 {
-	// Check to see if Ammo matches the AmmoType
-	if (AmmoMap.Find(Ammo->GetAmmoType()))
-	{
-		int32 AmmoCount{ AmmoMap[Ammo->GetAmmoType()] };
-		AmmoCount += Ammo->GetItemCount();
-		AmmoMap[Ammo->GetAmmoType()] = AmmoCount;
-	}
+	Inventory->AddAmmo(Ammo->GetAmmoType(), Ammo->GetItemCount());
 
 	if (EquippedWeapon->GetAmmoType() == Ammo->GetAmmoType())
 	{
@@ -616,15 +783,31 @@ void AShooterCharacter::ResetEquipSoundTimer()
 
 void AShooterCharacter::ExchangeInventoryItems(int32 CurrentItemIndex, int32 NewItemIndex)
 {
-	if ((CombatState != ECombatState::ECS_Unoccupied) || (CurrentItemIndex == NewItemIndex) || (NewItemIndex >= Inventory.Num())) return;
+	if ((CombatState != ECombatState::ECS_Unoccupied) || (CurrentItemIndex == NewItemIndex) || !Inventory->IsSlotOccupied(NewItemIndex)) return;
 
 	if (bAiming) StopAiming();
 
+	// Only the equipped Weapon is an actor, the one being put away goes back to being a record
+	// Equipping off a stack splits one Weapon into a slot of its own, so putting it away later doesn't overwrite the rest of the stack
+	const FWeaponRecord& NewRecord{ *Inventory->GetSlot(NewItemIndex) };
+	const bool bSplitStack{ NewRecord.StackCount > 1 };
+	if (bSplitStack && Inventory->IsFull()) return;
+
+	auto NewWeapon = AcquireInventoryWeapon(NewRecord);
+	if (NewWeapon == nullptr) return;
+
+	if (bSplitStack)
+	{
+		Inventory->RemoveWeapon(NewItemIndex);
+		const int32 SplitSlot{ Inventory->GetFreeSlot() };
+		NewWeapon->SetSlotIndex(SplitSlot);
+		Inventory->SetSlot(SplitSlot, NewWeapon->MakeRecord());
+	}
+
 	auto OldEquippedWeapon = EquippedWeapon;
-	auto NewWeapon = Cast<AWeapon>(Inventory[NewItemIndex]);
+	Inventory->SetSlot(CurrentItemIndex, OldEquippedWeapon->MakeRecord());
 	EquipWeapon(NewWeapon);
-	OldEquippedWeapon->SetItemState(EItemState::EIS_PickedUp);
-	NewWeapon->SetItemState(EItemState::EIS_Equipped);
+	ReleaseInventoryWeapon(OldEquippedWeapon);
 
 	CombatState = ECombatState::ECS_Equipping;
 	auto AnimInstance = GetMesh()->GetAnimInstance();
@@ -641,34 +824,48 @@ void AShooterCharacter::SwitchIndexItems(int32 Index)
 	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), Index);
 }
 
-int32 AShooterCharacter::GetEmptyInventorySlot()
-{
-	for (int32 i = 0; i < Inventory.Num(); i++)
-	{
-		if (Inventory[i] == nullptr) return i;
-	}
-
-	if (Inventory.Num() < INVENTORY_CAPACITY) return Inventory.Num();
-
-	return -1;
-}
-
 void AShooterCharacter::HighlightInventorySlot()
 {
-	const int32 EmptySlot{ GetEmptyInventorySlot() };
+	const int32 EmptySlot{ Inventory->GetFreeSlot() };
 	HighlightIconDelegate.Broadcast(EmptySlot, true);
 	HighlightedSlot = EmptySlot;
 }
 
 UPARAM(DisplayName = "Physical Surface") EPhysicalSurface AShooterCharacter::GetSurfaceType()
 {
-	FHitResult HitResult;
-	const FVector Start{ GetActorLocation() }, End{ Start + FVector(0.f, 0.f, -400.f) };
-	FCollisionQueryParams QueryParams;
-	QueryParams.bReturnPhysicalMaterial = true;
-	GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams);
+	// CharacterMovement already found the floor this frame, only look up its material when it changes
+	const FHitResult& FloorHit{ GetCharacterMovement()->CurrentFloor.HitResult };
+	UPrimitiveComponent* FloorComponent{ FloorHit.GetComponent() };
+	if (FloorComponent != CachedFloorComponent.Get())
+	{
+		CachedFloorComponent = FloorComponent;
 
-	return UPhysicalMaterial::DetermineSurfaceType(HitResult.PhysMaterial.Get());
+		// The floor sweep doesn't usually return a material, a short trace resolves the one under the feet (per face on complex collision)
+		UPhysicalMaterial* FloorMaterial{ FloorHit.PhysMaterial.Get() };
+		if (FloorMaterial == nullptr && FloorComponent)
+		{
+			FHitResult HitResult;
+			const FVector Start{ GetActorLocation() }, End{ Start + FVector(0.f, 0.f, -400.f) };
+			FCollisionQueryParams QueryParams;
+			QueryParams.bReturnPhysicalMaterial = true;
+			QueryParams.AddIgnoredActor(this);
+			GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams);
+			FloorMaterial = HitResult.PhysMaterial.Get();
+		}
+
+		CachedFloorSurface = UPhysicalMaterial::DetermineSurfaceType(FloorMaterial);
+	}
+
+	return CachedFloorSurface;
+}
+
+void AShooterCharacter::PlayFootstep(const FVector& Location)
+{
+	if (SurfaceEffects == nullptr) return;
+
+	const FSurfaceEffect& Effect{ SurfaceEffects->GetEffect(GetSurfaceType()) };
+	if (Effect.FootstepSound) UGameplayStatics::PlaySoundAtLocation(this, Effect.FootstepSound, Location);
+	if (Effect.FootstepParticles) UFXPoolSubsystem::SpawnEmitterAtLocation(this, Effect.FootstepParticles, Location);
 }
 
 void AShooterCharacter::EndStun()
@@ -709,36 +906,6 @@ void AShooterCharacter::Stun()
 	if (AnimInstance && HitReactMontage) AnimInstance->Montage_Play(HitReactMontage);
 }
 
-void AShooterCharacter::FKeyPressed()
-{
-	SwitchIndexItems(0);
-}
-
-void AShooterCharacter::OneKeyPressed()
-{
-	SwitchIndexItems(1);
-}
-
-void AShooterCharacter::TwoKeyPressed()
-{
-	SwitchIndexItems(2);
-}
-
-void AShooterCharacter::ThreeKeyPressed()
-{
-	SwitchIndexItems(3);
-}
-
-void AShooterCharacter::FourKeyPressed()
-{
-	SwitchIndexItems(4);
-}
-
-void AShooterCharacter::FiveKeyPressed()
-{
-	SwitchIndexItems(5);
-}
-
 int32 AShooterCharacter::GetInterpLocationIndex()
 {
 	int32 LowestIndex = 1, LowestCount = INT_MAX;
@@ -835,30 +1002,110 @@ void AShooterCharacter::FireButtonReleased()
 	bFireButtonPressed = false;
 }
 
-void AShooterCharacter::StartFireButtonTimer()
+void AShooterCharacter::StartAutoFire()
 {
 	if (EquippedWeapon == nullptr) return;
 
 	CombatState = ECombatState::ECS_FireTimerInProgress;
 
-	GetWorldTimerManager().SetTimer(AutoFireTimer, this, &AShooterCharacter::AutoFireReset, EquippedWeapon->GetAutoFireRate());	
+	// Firing comes from input, before this frame's Tick, so the UpdateAutoFire() later this frame mustn't count the frame toward the cooldown
+	AutoFireAccumulator = -GetWorld()->GetDeltaSeconds();
 }
 
-void AShooterCharacter::AutoFireReset()
+void AShooterCharacter::UpdateAutoFire(float DeltaTime)
 {
-	if (CombatState == ECombatState::ECS_Stunned) return;
+	if (CombatState != ECombatState::ECS_FireTimerInProgress || EquippedWeapon == nullptr) return;
 
-	CombatState = ECombatState::ECS_Unoccupied;
-	if (EquippedWeapon == nullptr) return;
+	// Keep last frame's crosshairs so shots that came due during this frame can be aimed in between
+	const FVector PreviousCrosshairStart{ LastCrosshairStart }, PreviousCrosshairDirection{ LastCrosshairDirection };
+	FVector CrosshairStart{ LastCrosshairStart }, CrosshairEnd{ LastCrosshairStart + LastCrosshairDirection * 50'000.f };
+	if (GetCrosshairTraceSegment(UGameplayStatics::GetPlayerController(this, 0), CrosshairStart, CrosshairEnd))
+	{
+		LastCrosshairStart = CrosshairStart;
+		LastCrosshairDirection = (CrosshairEnd - CrosshairStart).GetSafeNormal();
+	}
 
-	if (WeaponHasAmmo())
+	AutoFireAccumulator += DeltaTime;
+	const float FireRate{ FMath::Max(EquippedWeapon->GetAutoFireRate(), KINDA_SMALL_NUMBER) };
+	if (AutoFireAccumulator < FireRate) return;
+
+	if (!WeaponHasAmmo())
+	{
+		CombatState = ECombatState::ECS_Unoccupied;
+		ReloadWeapon();
+		return;
+	}
+	if (!bFireButtonPressed || !EquippedWeapon->GetAutomatic())
+	{
+		CombatState = ECombatState::ECS_Unoccupied;
+		return;
+	}
+
+	const float TraceLength{ static_cast<float>(FVector::Dist(CrosshairStart, CrosshairEnd)) };
+	const FQuat PreviousAim{ PreviousCrosshairDirection.ToOrientationQuat() }, CurrentAim{ LastCrosshairDirection.ToOrientationQuat() };
+	const float FrameEndTime{ GetWorld()->GetTimeSeconds() };
+	const int32 MaxShots{ FMath::Min(FMath::Max(CVarAutoFireMaxShotsPerFrame.GetValueOnGameThread(), 1), EquippedWeapon->GetAmmo()) };
+
+	TArray<FBulletShot, TInlineAllocator<8>> Shots;
+	while (AutoFireAccumulator >= FireRate && Shots.Num() < MaxShots)
 	{
-		if (bFireButtonPressed && EquippedWeapon->GetAutomatic()) FireWeapon();
+		AutoFireAccumulator -= FireRate;
+
+		// This shot fired AutoFireAccumulator seconds before the end of the frame
+		const float Alpha{ DeltaTime > 0.f ? FMath::Clamp(1.f - AutoFireAccumulator / DeltaTime, 0.f, 1.f) : 1.f };
+		FBulletShot& Shot{ Shots.AddDefaulted_GetRef() };
+		Shot.Timestamp = FrameEndTime - AutoFireAccumulator;
+		Shot.CrosshairStart = FMath::Lerp(PreviousCrosshairStart, LastCrosshairStart, Alpha);
+		Shot.CrosshairEnd = Shot.CrosshairStart + FQuat::Slerp(PreviousAim, CurrentAim, Alpha).GetForwardVector() * TraceLength;
 	}
-	else ReloadWeapon();
+
+	// Drop whatever the cap didn't allow instead of firing it as a burst next frame
+	AutoFireAccumulator = FMath::Min(AutoFireAccumulator, FireRate);
+
+	FireShots(Shots);
 }
 
 bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation)
+{
+	INC_DWORD_STAT(STAT_CrosshairTraceRequests);
+
+	APlayerController* PlayerController{ UGameplayStatics::GetPlayerController(this, 0) };
+	if (PlayerController == nullptr) return false;
+
+	// Reuse the trace already issued this frame if the camera hasn't moved since
+	FVector CameraLocation{ FVector::ZeroVector };
+	FRotator CameraRotation{ FRotator::ZeroRotator };
+	if (PlayerController->PlayerCameraManager)
+	{
+		CameraLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		CameraRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
+		if (CrosshairTraceCache.IsValidFor(GFrameCounter, CameraLocation, CameraRotation))
+		{
+			OutHitResult = CrosshairTraceCache.HitResult;
+			OutHitLocation = CrosshairTraceCache.HitLocation;
+			return CrosshairTraceCache.bHit;
+		}
+	}
+
+	FVector Start, End;
+	if (!GetCrosshairTraceSegment(PlayerController, Start, End)) return false;
+
+	OutHitLocation = End;
+	INC_DWORD_STAT(STAT_CrosshairTracesIssued);
+	GetWorld()->LineTraceSingleByChannel(OutHitResult, Start, End, ECC_Visibility);
+	if (OutHitResult.bBlockingHit) OutHitLocation = OutHitResult.Location;
+
+	CrosshairTraceCache.FrameNumber = GFrameCounter;
+	CrosshairTraceCache.CameraLocation = CameraLocation;
+	CrosshairTraceCache.CameraRotation = CameraRotation;
+	CrosshairTraceCache.HitResult = OutHitResult;
+	CrosshairTraceCache.HitLocation = OutHitLocation;
+	CrosshairTraceCache.bHit = OutHitResult.bBlockingHit;
+
+	return CrosshairTraceCache.bHit;
+}
+
+bool AShooterCharacter::GetCrosshairTraceSegment(APlayerController* PlayerController, FVector& OutStart, FVector& OutEnd)
 {
 	// Get current size of the viewport
 	FVector2D ViewportSize;
@@ -869,19 +1116,12 @@ bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector&
 	FVector CrosshairWorldPosition, CrosshairWorldDirection;
 
 	// Get world position and direction of crosshairs
-	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(UGameplayStatics::GetPlayerController(this, 0), CrosshairLocation, CrosshairWorldPosition, CrosshairWorldDirection);
-	if (bScreenToWorld)
-	{
-		const FVector Start{ CrosshairWorldPosition }, End{ Start + CrosshairWorldDirection * 50'000.f };
-		OutHitLocation = End;
-		GetWorld()->LineTraceSingleByChannel(OutHitResult, Start, End, ECC_Visibility);
-		if (OutHitResult.bBlockingHit)
-		{
-			OutHitLocation = OutHitResult.Location;
-			return true;
-		}
-	}
-	return false;
+	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(PlayerController, CrosshairLocation, CrosshairWorldPosition, CrosshairWorldDirection);
+	if (!bScreenToWorld) return false;
+
+	OutStart = CrosshairWorldPosition;
+	OutEnd = OutStart + CrosshairWorldDirection * 50'000.f;
+	return true;
 }
 
 // Called to bind functionality to input
@@ -899,12 +1139,13 @@ void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 	PlayerInputComponent->BindAction("EquipItem", IE_Pressed, this, &AShooterCharacter::EquipButtonPressed);
 	PlayerInputComponent->BindAction("ReloadWeapon", IE_Pressed, this, &AShooterCharacter::ReloadButtonPressed);
 	PlayerInputComponent->BindAction("Crouch", IE_Pressed, this, &AShooterCharacter::CrouchButtonPressed);
-	PlayerInputComponent->BindAction("FKey", IE_Pressed, this, &AShooterCharacter::FKeyPressed);
-	PlayerInputComponent->BindAction("OneKey", IE_Pressed, this, &AShooterCharacter::OneKeyPressed);
-	PlayerInputComponent->BindAction("TwoKey", IE_Pressed, this, &AShooterCharacter::TwoKeyPressed);
-	PlayerInputComponent->BindAction("ThreeKey", IE_Pressed, this, &AShooterCharacter::ThreeKeyPressed);
-	PlayerInputComponent->BindAction("FourKey", IE_Pressed, this, &AShooterCharacter::FourKeyPressed);
-	PlayerInputComponent->BindAction("FiveKey", IE_Pressed, this, &AShooterCharacter::FiveKeyPressed);
+
+	// One generic select action per slot, the first ones keep their original key names
+	for (int32 i = 0; i < Inventory->GetCapacity(); i++)
+	{
+		const FName ActionName{ i < static_cast<int32>(UE_ARRAY_COUNT(ShooterInput::SlotActionNames)) ? ShooterInput::SlotActionNames[i] : FName(*FString::Printf(TEXT("SelectSlot%d"), i)) };
+		PlayerInputComponent->BindAction<FSelectSlotDelegate>(ActionName, IE_Pressed, this, &AShooterCharacter::SwitchIndexItems, i);
+	}
 
 	PlayerInputComponent->BindAxis("MoveForward", this, &AShooterCharacter::MoveForward);
 	PlayerInputComponent->BindAxis("MoveRight", this, &AShooterCharacter::MoveRight);
@@ -941,11 +1182,11 @@ void AShooterCharacter::GetPickupItem(AItem* Item)
 	auto Weapon = Cast<AWeapon>(Item);
 	if (Weapon)
 	{
-		if (Inventory.Num() < INVENTORY_CAPACITY)
+		const int32 SlotIndex{ Inventory->AddWeapon(Weapon->MakeRecord()) };
+		if (SlotIndex != INDEX_NONE)
 		{
-			Weapon->SetSlotIndex(Inventory.Num());
-			Inventory.Add(Weapon);
-			Weapon->SetItemState(EItemState::EIS_PickedUp);
+			Weapon->SetSlotIndex(SlotIndex);
+			ReleaseInventoryWeapon(Weapon);
 		}
 		else SwapWeapon(Weapon);
 	}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "AmmoType.h"
+#include "Weapon.h"
 #include "ShooterCharacter.generated.h"
 
 class USpringArmComponent;
@@ -14,6 +15,9 @@ class AWeapon;
 class AAmmo;
 class AController;
 class USoundCue;
+class UInventoryComponent;
+class USurfaceEffectsDataAsset;
+class UHitscanSubsystem;
 
 UENUM(BlueprintType)
 enum class ECombatState : uint8
@@ -40,8 +44,44 @@ struct FInterpLocation
 	int32 ItemCount;
 };
 
+/* One bullet of the shots fired in a frame, aimed where the crosshairs pointed when it fired */
+struct FBulletShot
+{
+	/* World time the shot fired at, which can fall between two frames */
+	float Timestamp{ 0.f };
+
+	/* Crosshair trace the shot follows */
+	FVector CrosshairStart{ FVector::ZeroVector };
+	FVector CrosshairEnd{ FVector::ZeroVector };
+
+	/* True when the shot follows this frame's crosshairs and can share the cached crosshair trace */
+	bool bCurrentAim{ false };
+};
+
+/* Result of the crosshair trace, reused by every caller within the same frame */
+struct FCrosshairTraceCache
+{
+	/* Frame the cached trace was issued on */
+	uint64 FrameNumber{ MAX_uint64 };
+
+	/* Camera transform the cached trace was issued from */
+	FVector CameraLocation{ FVector::ZeroVector };
+	FRotator CameraRotation{ FRotator::ZeroRotator };
+
+	/* Results of the cached trace */
+	FHitResult HitResult;
+	FVector HitLocation{ FVector::ZeroVector };
+	bool bHit{ false };
+
+	bool IsValidFor(uint64 Frame, const FVector& Location, const FRotator& Rotation) const
+	{
+		return FrameNumber == Frame && CameraLocation.Equals(Location) && CameraRotation.Equals(Rotation);
+	}
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FEquipItemDelegate, int32, CurrentSlotIndex, int32, NewSlotIndex);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FHighlightIconDelegate, int32, SlotIndex, bool, bStartAnimation);
+DECLARE_DELEGATE_OneParam(FSelectSlotDelegate, int32);
 
 UCLASS()
 class BELICABADASS_API AShooterCharacter : public ACharacter
@@ -62,6 +102,9 @@ protected:
 	// Make sure camera isn't zoomed in when game starts
 	void SetDefaultCameraView();
 
+	// Pre-allocates pooled components for the FX spawned on every shot
+	void PrewarmFiringFX();
+
 	// Called for forwards and backwards input
 	void MoveForward(float Value);
 
@@ -80,11 +123,32 @@ protected:
 	// Plays the animation for firing the Weapon
 	void PlayGunFireMontage();
 
-	// Starts the line trace to determine direction of particles and impact points
-	void SendBullet();
+	// Plays the fire sound, montage and crosshair spread once for every shot in Shots and sends their bullets
+	void FireShots(TArrayView<const FBulletShot> Shots);
+
+	// Traces every shot from the gun barrel, then resolves the hits into damage, impacts and beams
+	void SendBullets(TArrayView<const FBulletShot> Shots);
+
+	// Queues the barrel trace of every shot with the hitscan subsystem, the hits are resolved next frame
+	void QueueBullets(UHitscanSubsystem* Hitscan, const FTransform& SocketTransform, TArrayView<const FBulletShot> Shots);
 
-	// Returns true when the line trace hits an object
-	bool GetBeamEndLocation(const FVector& MuzzleSocketLocation, FHitResult& OutHitResult);
+	// Where Shot's crosshairs point, bUseFrameAimDepth reuses the depth of this frame's crosshair trace instead of tracing Shot's own ray
+	FVector GetShotAimLocation(const FBulletShot& Shot, bool bUseFrameAimDepth);
+
+	// Query params of the barrel trace, which returns the physical material for surface impacts
+	static FCollisionQueryParams GetWeaponTraceParams();
+
+	// End of the barrel trace toward AimLocation
+	static FVector GetWeaponTraceEnd(const FVector& MuzzleSocketLocation, const FVector& AimLocation);
+
+	// Returns true when the line trace of Shot hits an object
+	bool GetBeamEndLocation(const FVector& MuzzleSocketLocation, const FBulletShot& Shot, FHitResult& OutHitResult);
+
+	// Applies damage and spawns the impact and beam for a bullet whose barrel trace hit something, with the damage of the Weapon that fired it
+	void ResolveBulletHit(const FHitResult& BeamHitResult, const FTransform& SocketTransform, float Damage, float HeadShotDamage);
+
+	// Spawns the particles, sound and decal for the surface a bullet hit, taken from the hit's physical material
+	void SpawnImpactEffects(const FHitResult& HitResult);
 
 	// Called when Aiming button is pressed
 	void AimingButtonPressed();
@@ -109,19 +173,24 @@ protected:
 	void FireButtonPressed();
 	void FireButtonReleased();
 
-	// Calls FireWeapon() and starts the timer for automatic gun fire
-	void StartFireButtonTimer();
+	// Starts the fire cooldown that UpdateAutoFire() counts down
+	void StartAutoFire();
 
-	// Ends the timer for automatic gun fire unless the fire weapon button is still pressed
-	UFUNCTION()
-	void AutoFireReset();
-
-	// Line trace for Items under the crosshairs
-	bool TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation);
+	// Fires every shot that came due this frame while the fire weapon button is held, and ends the cooldown otherwise
+	void UpdateAutoFire(float DeltaTime);
 
 	// Trace for items if OverlappedItemCount > 0
 	void TraceForItems();
 
+	// Consumes last frame's async item trace and issues the next one
+	void TraceForItemsAsync();
+
+	// Highlights the Item hit by the item trace and updates the pickup widget and inventory slot
+	void UpdateTraceHitItem(const FHitResult& ItemTraceResult);
+
+	// Gets the world space start and end of a trace from the crosshairs
+	bool GetCrosshairTraceSegment(APlayerController* PlayerController, FVector& OutStart, FVector& OutEnd);
+
 	// Spawns the Weapon the character is holding when the game starts
 	AWeapon* SpawnDefaultWeapon();
 
@@ -137,8 +206,14 @@ protected:
 	// Drops EquippedWeapon and equips TraceHitItem
 	void SwapWeapon(AWeapon* WeaponToSwap);
 
-	// Initialize the AmmoMap with Ammo values
-	void InitializeAmmoMap();
+	// Rehydrates the Weapon in an Inventory record from the weapon pool
+	AWeapon* AcquireInventoryWeapon(const FWeaponRecord& Record);
+
+	// Hands a Weapon that is now only an Inventory record back to the weapon pool
+	void ReleaseInventoryWeapon(AWeapon* Weapon);
+
+	// Gives the Inventory the starting Ammo values
+	void InitializeAmmo();
 
 	// Check to make sure our Weapon has ammo
 	bool WeaponHasAmmo();
@@ -183,26 +258,23 @@ protected:
 
 	void ResetEquipSoundTimer();
 
-	// Allows the Character to select Weapons in Inventory
-	void FKeyPressed();
-	void OneKeyPressed();
-	void TwoKeyPressed();
-	void ThreeKeyPressed();
-	void FourKeyPressed();
-	void FiveKeyPressed();
-
 	void ExchangeInventoryItems(int32 CurrentItemIndex, int32 NewItemIndex);
 
+	// Equips the Weapon in Index, every slot select input is bound to this
+	UFUNCTION(BlueprintCallable, Category = Inventory)
 	void SwitchIndexItems(int32 Index);
 
-	int32 GetEmptyInventorySlot();
-
 	void HighlightInventorySlot();
 
+	// Surface under the Character, taken from CharacterMovement's floor and cached until the floor component changes
 	UFUNCTION(BlueprintCallable)
 	UPARAM(DisplayName = "Physical Surface") 
 	EPhysicalSurface GetSurfaceType();
 
+	// Plays the footstep sound and particles of the surface under the Character at Location
+	UFUNCTION(BlueprintCallable)
+	void PlayFootstep(const FVector& Location);
+
 	UFUNCTION(BlueprintCallable)
 	void EndStun();
 
@@ -222,6 +294,10 @@ public:
 	UFUNCTION(BlueprintCallable)
 	float GetCrosshairSpreadMultiplier() const;
 
+	// Line trace under the crosshairs, cached per frame and camera transform so every caller shares one trace
+	UFUNCTION(BlueprintCallable)
+	bool TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation);
+
 	// Adds or subtracts to or from OverlappedItemCount
 	void IncrementOverlappedItemCount(int8 Amount);
 
@@ -267,14 +343,28 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	UAnimMontage* HipFireMontage;
 
-	/* Particles spawned upon bullet impact */
+	/* Particles spawned upon bullet impact when the surface has none of its own */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	UParticleSystem* ImpactParticles;
 
+	/* Footstep and bullet impact effects for each surface */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	USurfaceEffectsDataAsset* SurfaceEffects;
+
+	/* Floor component the cached surface was taken from */
+	TWeakObjectPtr<UPrimitiveComponent> CachedFloorComponent;
+
+	/* Surface of CachedFloorComponent */
+	TEnumAsByte<EPhysicalSurface> CachedFloorSurface;
+
 	/* Smoke trail for bullets */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	UParticleSystem* BeamParticles;
 
+	/* Number of pooled components created up front for each of the firing FX */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	int32 FXPrewarmCount;
+
 	/* True when the Character is Aiming */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bAiming;
@@ -310,12 +400,22 @@ private:
 	/* True when the Character is able to fire the weapon */
 	bool bShouldFire;
 
-	/* Sets a timer*/
-	FTimerHandle AutoFireTimer;
+	/* Seconds since the last shot, a shot fires each time it passes the Weapon's AutoFireRate */
+	float AutoFireAccumulator;
+
+	/* Crosshair trace of the last frame, shots fired between frames aim between it and the current one */
+	FVector LastCrosshairStart;
+	FVector LastCrosshairDirection;
+
+	/* Crosshair trace shared by item tracing and weapon fire for the current frame */
+	FCrosshairTraceCache CrosshairTraceCache;
 
 	/* True if we should trace every frame for Items */
 	bool bShouldTraceForItems;
 
+	/* Handle of the async item trace issued last frame */
+	FTraceHandle ItemTraceHandle;
+
 	/* Number of overlapped Items */
 	int8 OverlappedItemCount;
 
@@ -343,10 +443,6 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
 	float CameraInterpElevation;
 
-	/* Map to keep track of Ammo of the different ammo types  */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
-	TMap<EAmmoType, int32> AmmoMap;
-
 	/* Starting amount of 9mm Ammo*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
 	int32 Starting9mmAmmo;
@@ -448,11 +544,9 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item, meta = (AllowPrivateAccess = "true"))
 	float EquipSoundResetTime;
 
-	/* An array of Items for our Inventory */
+	/* Weapon records and carried Ammo, only the EquippedWeapon is a live actor; its record is refreshed when it is put away */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
-	TArray<AItem*> Inventory;
-
-	const int32 INVENTORY_CAPACITY{ 6 };
+	UInventoryComponent* Inventory;
 
 	/* Delegate for sending slot informaiton to Inventory Bar when equipping */
 	UPROPERTY(BlueprintAssignable, Category = Delegates, meta = (AllowPrivateAccess = "true"))
@@ -500,6 +594,7 @@ private:
 
 public:
 	// Getters for private variables
+	FORCEINLINE UInventoryComponent* GetInventory() const { return Inventory; }
 	FORCEINLINE AWeapon* GetEquippedWeapon() const { return EquippedWeapon; }
 	FORCEINLINE bool GetAiming() const { return bAiming; }
 	FORCEINLINE bool GetCrouching() const { return bCrouching; }
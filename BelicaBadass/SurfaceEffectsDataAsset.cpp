@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurfaceEffectsDataAsset.h"
+
+USurfaceEffectsDataAsset::USurfaceEffectsDataAsset()
+{
+	Effects.SetNum(static_cast<int32>(ESurfaceEffect::ESE_MAX));
+}
+
+const FSurfaceEffect& USurfaceEffectsDataAsset::GetEffect(EPhysicalSurface Surface) const
+{
+	const int32 Index{ static_cast<int32>(SurfaceEffects::Map[Surface]) };
+	return Effects.IsValidIndex(Index) ? Effects[Index] : Effects[static_cast<int32>(ESurfaceEffect::ESE_Default)];
+}
+
+void USurfaceEffectsDataAsset::PostLoad()
+{
+	Super::PostLoad();
+
+	// Keep one entry per ESurfaceEffect so lookups can index straight in, even for assets saved before a surface was added
+	Effects.SetNum(static_cast<int32>(ESurfaceEffect::ESE_MAX));
+}
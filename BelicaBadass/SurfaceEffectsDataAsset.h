@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Engine/EngineTypes.h"
+#include "BelicaBadass.h"
+#include "SurfaceEffectsDataAsset.generated.h"
+
+class USoundCue;
+class UParticleSystem;
+class UMaterialInterface;
+
+/* Surfaces with their own effects, the index into USurfaceEffectsDataAsset's table */
+UENUM(BlueprintType)
+enum class ESurfaceEffect : uint8
+{
+	ESE_Default UMETA(DisplayName = "Default"),
+	ESE_Metal UMETA(DisplayName = "Metal"),
+	ESE_Stone UMETA(DisplayName = "Stone"),
+	ESE_Tile UMETA(DisplayName = "Tile"),
+	ESE_Grass UMETA(DisplayName = "Grass"),
+	ESE_Water UMETA(DisplayName = "Water"),
+	ESE_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+/* ESurfaceEffect for every EPhysicalSurface, filled in at compile time from the EPS_* mapping in BelicaBadass.h */
+struct FSurfaceEffectMap
+{
+	ESurfaceEffect Effects[SurfaceType_Max];
+
+	constexpr FSurfaceEffectMap() :
+		Effects{}
+	{
+		Effects[EPS_Metal] = ESurfaceEffect::ESE_Metal;
+		Effects[EPS_Stone] = ESurfaceEffect::ESE_Stone;
+		Effects[EPS_Tile] = ESurfaceEffect::ESE_Tile;
+		Effects[EPS_Grass] = ESurfaceEffect::ESE_Grass;
+		Effects[EPS_Water] = ESurfaceEffect::ESE_Water;
+	}
+
+	constexpr ESurfaceEffect operator[](EPhysicalSurface Surface) const
+	{
+		return Surface < SurfaceType_Max ? Effects[Surface] : ESurfaceEffect::ESE_Default;
+	}
+};
+
+namespace SurfaceEffects
+{
+	constexpr FSurfaceEffectMap Map;
+	static_assert(Map[EPS_Water] == ESurfaceEffect::ESE_Water && Map[SurfaceType_Default] == ESurfaceEffect::ESE_Default, "Surface effect map is out of sync with the EPS_* mapping");
+}
+
+USTRUCT(BlueprintType)
+struct FSurfaceEffect
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	USoundCue* FootstepSound{ nullptr };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	UParticleSystem* FootstepParticles{ nullptr };
+
+	/* Spawned where a bullet hits this surface, the Character's ImpactParticles are used when empty */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	UParticleSystem* ImpactParticles{ nullptr };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	USoundCue* ImpactSound{ nullptr };
+
+	/* Decal left where a bullet hits this surface, its material reads the fade through a DecalLifetimeOpacity node */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	UMaterialInterface* ImpactDecal{ nullptr };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	FVector ImpactDecalSize{ 8.f, 8.f, 8.f };
+
+	/* Seconds the impact decal stays before it starts fading */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float ImpactDecalLifeSpan{ 10.f };
+
+	/* Seconds the impact decal takes to fade out */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float ImpactDecalFadeDuration{ 1.f };
+};
+
+/**
+ * Effects for each ESurfaceEffect, looked up by physical surface without any searching
+ */
+UCLASS(BlueprintType)
+class BELICABADASS_API USurfaceEffectsDataAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	USurfaceEffectsDataAsset();
+
+	// Effects for Surface, falling back to the Default entry for surfaces without their own
+	const FSurfaceEffect& GetEffect(EPhysicalSurface Surface) const;
+
+	FORCEINLINE const TArray<FSurfaceEffect>& GetEffects() const { return Effects; }
+
+	virtual void PostLoad() override;
+
+private:
+	/* Effects indexed by ESurfaceEffect */
+	UPROPERTY(EditAnywhere, Category = "Surface Effects", meta = (EditFixedSize))
+	TArray<FSurfaceEffect> Effects;
+};
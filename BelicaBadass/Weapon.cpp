@@ -2,22 +2,19 @@
 
 
 #include "Weapon.h"
+#include "ItemDataSubsystem.h"
+#include "Engine/SkeletalMeshSocket.h"
 
 AWeapon::AWeapon() :
 	ThrowWeaponTime(.7f),
 	bFalling(false),
 	Ammo(30),
-	MagazineCapacity(30),
 	WeaponType(EWeaponType::EWT_SubmachineGun),
-	AmmoType(EAmmoType::EAT_9mm),
-	ReloadMontageSection(FName("")),
-	ClipBoneName(FName("")),
 	bMovingClip(false),
 	SlideDisplacement(0.f),
 	SlideDisplacementTime(0.1f),
 	bMovingSlide(false),
-	MaxSlideDisplacement(4.f),
-	bAutomatic(true)
+	MaxSlideDisplacement(4.f)
 {
 	PrimaryActorTick.bCanEverTick = true;
 }
@@ -40,80 +37,179 @@ void AWeapon::KeepWeaponUpright()
 	}
 }
 
-void AWeapon::OnConstruction(const FTransform& Transform)
+void AWeapon::ApplyItemData()
 {
-	Super::OnConstruction(Transform);
+	Super::ApplyItemData();
 
-	const FString WeaponTablePath(TEXT("DataTable'/Game/_Game/DataTables/WeaponDataTable.WeaponDataTable'"));
-	UDataTable* WeaponTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *WeaponTablePath));
-	if (WeaponTableObject)
+	ResolveDescriptor();
+	if (Descriptor.IsValid())
 	{
-		FWeaponDataTable* WeaponDataRow = nullptr;
-		switch (WeaponType)
-		{
-		case EWeaponType::EWT_SubmachineGun:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("SubmachineGun"), TEXT(""));
-			break;
-		case EWeaponType::EWT_AssualtRifle:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("AssaultRifle"), TEXT(""));
-			break;
-		case EWeaponType::EWT_Pistol:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("Pistol"), TEXT(""));
-			break;
-		}
-
-		if (WeaponDataRow)
-		{
-			AmmoType = WeaponDataRow->AmmoType;
-			Ammo = WeaponDataRow->WeaponAmmo;
-			MagazineCapacity = WeaponDataRow->MagazineCapacity;
-			SetPickupSound(WeaponDataRow->PickupSound);
-			SetEquipSound(WeaponDataRow->EquipSound);
-			GetItemMesh()->SetSkeletalMesh(WeaponDataRow->ItemMesh);
-			SetInventoryIcon(WeaponDataRow->InventoryIcon);
-			SetAmmoIcon(WeaponDataRow->AmmoIcon);
-
-			SetMaterialInstance(WeaponDataRow->MaterialInstance);
-			PreviousMaterialIndex = GetMaterialIndex();
-			GetItemMesh()->SetMaterial(PreviousMaterialIndex, nullptr);
-			SetMaterialIndex(WeaponDataRow->MaterialIndex);
-			SetClipBoneName(WeaponDataRow->ClipBoneName);
-			SetReloadMontageSection(WeaponDataRow->ReloadMontageSection);
-			GetItemMesh()->SetAnimInstanceClass(WeaponDataRow->AnimationBlueprint);
-			CrosshairsMiddle = WeaponDataRow->CrosshairsMiddle;
-			CrosshairsLeft = WeaponDataRow->CrosshairsLeft;
-			CrosshairsRight = WeaponDataRow->CrosshairsRight;
-			CrosshairsTop = WeaponDataRow->CrosshairsTop;
-			CrosshairsBottom = WeaponDataRow->CrosshairsBottom;
-			AutoFireRate = WeaponDataRow->AutoFireRate;
-			MuzzleFlash = WeaponDataRow->MuzzleFlash;
-			FireSound = WeaponDataRow->FireSound;
-			BoneToHide = WeaponDataRow->BoneToHide;
-			bAutomatic = WeaponDataRow->bAutomatic;
-			Damage = WeaponDataRow->Damage;
-			HeadShotDamage = WeaponDataRow->HeadShotDamage;
-		}
-
-		if (GetMaterialInstance())
-		{
-			SetDynamicMaterialInstance(UMaterialInstanceDynamic::Create(GetMaterialInstance(), this));
-			GetDynamicMaterialInstance()->SetVectorParameterValue(TEXT("FresnelColor"), GetGlowColor());
-			GetItemMesh()->SetMaterial(GetMaterialIndex(), GetDynamicMaterialInstance());
-			EnableGlowMaterial();
-		}
+		Ammo = Descriptor->Data.WeaponAmmo;
+
+		// The assets stream in through the item data registry instead of being loaded by the construction script
+		UItemDataSubsystem* ItemData{ UItemDataSubsystem::Get() };
+		if (ItemData) ItemData->PreloadWeapon(WeaponType, FSimpleDelegate::CreateUObject(this, &AWeapon::ApplyWeaponAssets, WeaponType));
 	}
 }
 
+void AWeapon::ApplyWeaponAssets(EWeaponType LoadedType)
+{
+	// The Weapon may have been reset to another type while the assets were loading
+	if (LoadedType != WeaponType || !Descriptor.IsValid()) return;
+
+	const FWeaponDataTable& WeaponData{ Descriptor->Data };
+	SetPickupSound(ResolveWeaponAsset(WeaponData.PickupSound));
+	SetEquipSound(ResolveWeaponAsset(WeaponData.EquipSound));
+	GetItemMesh()->SetSkeletalMesh(ResolveWeaponAsset(WeaponData.ItemMesh));
+	SetInventoryIcon(ResolveWeaponAsset(WeaponData.InventoryIcon));
+	SetAmmoIcon(ResolveWeaponAsset(WeaponData.AmmoIcon));
+
+	SetMaterialInstance(ResolveWeaponAsset(WeaponData.MaterialInstance));
+	PreviousMaterialIndex = GetMaterialIndex();
+	GetItemMesh()->SetMaterial(PreviousMaterialIndex, nullptr);
+	SetMaterialIndex(WeaponData.MaterialIndex);
+	GetItemMesh()->SetAnimInstanceClass(ResolveWeaponAsset(WeaponData.AnimationBlueprint));
+
+	ApplyGlowMaterial();
+
+	// Setting the mesh shows every bone again
+	if (WeaponData.BoneToHide != FName("None")) GetItemMesh()->HideBoneByName(WeaponData.BoneToHide, EPhysBodyOp::PBO_None);
+}
+
+void AWeapon::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// The descriptor isn't serialized, so find it again for Weapons that skipped OnConstruction
+	if (!Descriptor.IsValid()) ResolveDescriptor();
+}
+
+void AWeapon::ResolveDescriptor()
+{
+	// Every Weapon of this type shares one descriptor from the item data registry
+	UItemDataSubsystem* ItemData{ UItemDataSubsystem::Get() };
+	Descriptor = ItemData ? ItemData->GetWeaponDescriptor(WeaponType) : nullptr;
+}
+
 void AWeapon::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (BoneToHide != FName("None")) GetItemMesh()->HideBoneByName(BoneToHide, EPhysBodyOp::PBO_None);
+	PreloadAssets();
+
+	if (Descriptor.IsValid() && Descriptor->Data.BoneToHide != FName("None")) GetItemMesh()->HideBoneByName(Descriptor->Data.BoneToHide, EPhysBodyOp::PBO_None);
+}
+
+FWeaponRecord AWeapon::MakeRecord() const
+{
+	FWeaponRecord Record;
+	Record.WeaponClass = GetClass();
+	Record.WeaponType = WeaponType;
+	Record.Ammo = Ammo;
+	Record.Rarity = GetItemRarity();
+	Record.SlotIndex = GetSlotIndex();
+	return Record;
+}
+
+void AWeapon::ResetFromRecord(const FWeaponRecord& Record, const FTransform& SpawnTransform)
+{
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	WeaponType = Record.WeaponType;
+	SetItemRarity(Record.Rarity);
+	SetSlotIndex(Record.SlotIndex);
+	ApplyItemData();
+	SetActiveStars();
+
+	// ApplyItemData fills the clip, the record knows how much was left in it
+	Ammo = Record.Ammo;
+
+	SetActorHiddenInGame(false);
+}
+
+void AWeapon::Deactivate()
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	bFalling = false;
+	bMovingClip = false;
+	bMovingSlide = false;
+	SlideDisplacement = 0.f;
+
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	SetItemState(EItemState::EIS_PickedUp);
+	SetActorHiddenInGame(true);
+}
+
+void AWeapon::PreloadAssets() const
+{
+	UItemDataSubsystem* ItemData{ UItemDataSubsystem::Get() };
+	if (ItemData) ItemData->PreloadWeapon(WeaponType);
+}
+
+bool AWeapon::GetBarrelSocketTransform(FTransform& OutTransform) const
+{
+	// The precomputed bone index is only valid while the mesh is still the one the descriptor was built for
+	if (Descriptor.IsValid() && Descriptor->IndexedMesh.IsValid() && GetItemMesh()->SkeletalMesh == Descriptor->IndexedMesh.Get())
+	{
+		if (Descriptor->BarrelBoneIndex == INDEX_NONE) return false;
+
+		OutTransform = Descriptor->BarrelSocketLocalTransform * GetItemMesh()->GetBoneTransform(Descriptor->BarrelBoneIndex);
+		return true;
+	}
+
+	const USkeletalMeshSocket* BarrelSocket{ GetItemMesh()->GetSocketByName(TEXT("BarrelSocket")) };
+	if (BarrelSocket == nullptr) return false;
+
+	OutTransform = BarrelSocket->GetSocketTransform(GetItemMesh());
+	return true;
+}
+
+FTransform AWeapon::GetClipBoneTransform() const
+{
+	if (Descriptor.IsValid() && Descriptor->IndexedMesh.IsValid() && GetItemMesh()->SkeletalMesh == Descriptor->IndexedMesh.Get() && Descriptor->ClipBoneIndex != INDEX_NONE)
+	{
+		return GetItemMesh()->GetBoneTransform(Descriptor->ClipBoneIndex);
+	}
+
+	return GetItemMesh()->GetBoneTransform(GetItemMesh()->GetBoneIndex(GetClipBoneName()));
+}
+
+UTexture2D* AWeapon::GetCrosshairsMiddle() const
+{
+	return Descriptor.IsValid() ? ResolveWeaponAsset(Descriptor->Data.CrosshairsMiddle) : nullptr;
+}
+
+UTexture2D* AWeapon::GetCrosshairsLeft() const
+{
+	return Descriptor.IsValid() ? ResolveWeaponAsset(Descriptor->Data.CrosshairsLeft) : nullptr;
+}
+
+UTexture2D* AWeapon::GetCrosshairsRight() const
+{
+	return Descriptor.IsValid() ? ResolveWeaponAsset(Descriptor->Data.CrosshairsRight) : nullptr;
+}
+
+UTexture2D* AWeapon::GetCrosshairsBottom() const
+{
+	return Descriptor.IsValid() ? ResolveWeaponAsset(Descriptor->Data.CrosshairsBottom) : nullptr;
+}
+
+UTexture2D* AWeapon::GetCrosshairsTop() const
+{
+	return Descriptor.IsValid() ? ResolveWeaponAsset(Descriptor->Data.CrosshairsTop) : nullptr;
 }
 
 void AWeapon::FinishMovingSlide()
 {
 	bMovingSlide = false;
+	RefreshTickEnabled();
+}
+
+bool AWeapon::NeedsTick() const
+{
+	if (Super::NeedsTick()) return true;
+
+	return (GetItemState() == EItemState::EIS_Falling && bFalling) || (bMovingSlide && SlideDisplacementCurve);
 }
 
 void AWeapon::UpdateSlideDisplacement()
@@ -128,19 +224,20 @@ void AWeapon::UpdateSlideDisplacement()
 
 void AWeapon::ReloadAmmo(int32 Amount)
 {
-	checkf(Ammo + Amount <= MagazineCapacity, TEXT("Attempted to reload more than MagazineCapacity!!!"));
+	checkf(Ammo + Amount <= GetMagazineCapacity(), TEXT("Attempted to reload more than MagazineCapacity!!!"));
 	Ammo += Amount;
 }
 
 bool AWeapon::ClipIsFull()
 {
-	return Ammo >= MagazineCapacity;
+	return Ammo >= GetMagazineCapacity();
 }
 
 void AWeapon::StartSlideTimer()
 {
 	bMovingSlide = true;
 	GetWorldTimerManager().SetTimer(SlideTimer, this, &AWeapon::FinishMovingSlide, SlideDisplacementTime);
+	RefreshTickEnabled();
 }
 
 void AWeapon::ThrowWeapon()
@@ -159,6 +256,9 @@ void AWeapon::ThrowWeapon()
 	// Start the ThrowWeaponTimer
 	bFalling = true;
 	GetWorldTimerManager().SetTimer(ThrowWeaponTimer, this, &AWeapon::StopFalling, ThrowWeaponTime);
+	RefreshTickEnabled();
+
+	PreloadAssets();
 
 	EnableGlowMaterial();
 }
@@ -173,5 +273,5 @@ void AWeapon::StopFalling()
 	bFalling = false;
 	SetItemState(EItemState::EIS_Pickup);
 
-	StartPulseTimer();
+	StartPulse();
 }
@@ -11,6 +11,7 @@
 
 class USoundCue;
 class UWidgetComponent;
+class AWeapon;
 
 USTRUCT(BlueprintType)
 struct FWeaponDataTable : public FTableRowBase
@@ -27,22 +28,22 @@ struct FWeaponDataTable : public FTableRowBase
 	int32 MagazineCapacity;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* PickupSound;
+	TSoftObjectPtr<USoundCue> PickupSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* EquipSound;
+	TSoftObjectPtr<USoundCue> EquipSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USkeletalMesh* ItemMesh;
+	TSoftObjectPtr<USkeletalMesh> ItemMesh;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* InventoryIcon;
+	TSoftObjectPtr<UTexture2D> InventoryIcon;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* AmmoIcon;
+	TSoftObjectPtr<UTexture2D> AmmoIcon;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UMaterialInstance* MaterialInstance;
+	TSoftObjectPtr<UMaterialInstance> MaterialInstance;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int32 MaterialIndex;
@@ -54,31 +55,31 @@ struct FWeaponDataTable : public FTableRowBase
 	FName ReloadMontageSection;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSubclassOf<UAnimInstance> AnimationBlueprint;
+	TSoftClassPtr<UAnimInstance> AnimationBlueprint;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsMiddle;
+	TSoftObjectPtr<UTexture2D> CrosshairsMiddle;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsLeft;
+	TSoftObjectPtr<UTexture2D> CrosshairsLeft;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsRight;
+	TSoftObjectPtr<UTexture2D> CrosshairsRight;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsBottom;
+	TSoftObjectPtr<UTexture2D> CrosshairsBottom;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsTop;
+	TSoftObjectPtr<UTexture2D> CrosshairsTop;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float AutoFireRate;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UParticleSystem* MuzzleFlash;
+	TSoftObjectPtr<UParticleSystem> MuzzleFlash;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* FireSound;
+	TSoftObjectPtr<USoundCue> FireSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FName BoneToHide;
@@ -93,6 +94,81 @@ struct FWeaponDataTable : public FTableRowBase
 	float HeadShotDamage;
 };
 
+// Returns the asset behind a soft reference, loading it synchronously when a preload did not get to it first
+template<typename T>
+T* ResolveWeaponAsset(const TSoftObjectPtr<T>& Asset)
+{
+	if (Asset.IsNull()) return nullptr;
+
+	T* Loaded{ Asset.Get() };
+	if (Loaded) return Loaded;
+
+	UE_LOG(LogTemp, Verbose, TEXT("Weapon asset %s was not preloaded, loading it synchronously"), *Asset.ToString());
+	return Asset.LoadSynchronous();
+}
+
+template<typename T>
+UClass* ResolveWeaponAsset(const TSoftClassPtr<T>& Asset)
+{
+	if (Asset.IsNull()) return nullptr;
+
+	UClass* Loaded{ Asset.Get() };
+	if (Loaded) return Loaded;
+
+	UE_LOG(LogTemp, Verbose, TEXT("Weapon class %s was not preloaded, loading it synchronously"), *Asset.ToString());
+	return Asset.LoadSynchronous();
+}
+
+/**
+ * Runtime data for one weapon type, shared by every AWeapon of that type.
+ * Its assets are soft references, streamed in by UItemDataSubsystem::PreloadWeapon, which fills in the bone indices once ItemMesh is loaded.
+ */
+struct FWeaponDescriptor
+{
+	/* The weapon data table row this descriptor was built from */
+	FWeaponDataTable Data;
+
+	/* Bone of ItemMesh holding the clip, INDEX_NONE if it has none */
+	int32 ClipBoneIndex{ INDEX_NONE };
+
+	/* Bone the BarrelSocket is attached to, INDEX_NONE if the mesh has no BarrelSocket */
+	int32 BarrelBoneIndex{ INDEX_NONE };
+
+	/* BarrelSocket transform relative to BarrelBoneIndex */
+	FTransform BarrelSocketLocalTransform{ FTransform::Identity };
+
+	/* Mesh the bone indices were computed for, null until ItemMesh has been loaded */
+	TWeakObjectPtr<const USkeletalMesh> IndexedMesh;
+};
+
+/* A Weapon kept in an inventory as data, rehydrated into an AWeapon by UWeaponPoolSubsystem when it is equipped */
+USTRUCT(BlueprintType)
+struct FWeaponRecord
+{
+	GENERATED_BODY()
+
+	/* Blueprint class to rehydrate the Weapon as */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TSubclassOf<AWeapon> WeaponClass;
+
+	/* Weapon type, which also names the shared FWeaponDescriptor */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EWeaponType WeaponType{ EWeaponType::EWT_MAX };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Ammo{ 0 };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EItemRarity Rarity{ EItemRarity::EIR_Common };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SlotIndex{ INDEX_NONE };
+
+	/* Identical Weapons sharing this slot, only inventories that stack weapons go above 1 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 StackCount{ 1 };
+};
+
 /**
  * 
  */
@@ -119,6 +195,39 @@ public:
 
 	void StartSlideTimer();
 
+	// Compact record of this Weapon for an inventory
+	FWeaponRecord MakeRecord() const;
+
+	// Turns a pooled Weapon into the one described by Record and shows it at SpawnTransform
+	void ResetFromRecord(const FWeaponRecord& Record, const FTransform& SpawnTransform);
+
+	// Hides the Weapon, stops its timers and turns off collision so it can wait in the pool
+	void Deactivate();
+
+	// Starts streaming in this Weapon's assets, e.g. when it is placed, dropped or about to be equipped
+	void PreloadAssets() const;
+
+	// World transform of the BarrelSocket, false when the Weapon's mesh has none
+	bool GetBarrelSocketTransform(FTransform& OutTransform) const;
+
+	// World transform of the clip bone
+	FTransform GetClipBoneTransform() const;
+
+	UFUNCTION(BlueprintPure, Category = "Weapon Properties")
+	UTexture2D* GetCrosshairsMiddle() const;
+
+	UFUNCTION(BlueprintPure, Category = "Weapon Properties")
+	UTexture2D* GetCrosshairsLeft() const;
+
+	UFUNCTION(BlueprintPure, Category = "Weapon Properties")
+	UTexture2D* GetCrosshairsRight() const;
+
+	UFUNCTION(BlueprintPure, Category = "Weapon Properties")
+	UTexture2D* GetCrosshairsBottom() const;
+
+	UFUNCTION(BlueprintPure, Category = "Weapon Properties")
+	UTexture2D* GetCrosshairsTop() const;
+
 protected:
 	// Called when Weapon
 	void StopFalling();
@@ -126,14 +235,27 @@ protected:
 	// Keeps Weapon upright when thrown to the ground
 	void KeepWeaponUpright();
 
-	virtual void OnConstruction(const FTransform& Transform) override;
+	// Applies the shared descriptor for WeaponType on top of the rarity data
+	virtual void ApplyItemData() override;
+
+	// Placed Weapons are duplicated for PIE and loaded in cooked builds without running the construction script
+	virtual void PostInitializeComponents() override;
 
 	virtual void BeginPlay() override;
 
+	// Points Descriptor at the shared descriptor for WeaponType
+	void ResolveDescriptor();
+
+	// Puts the mesh, sounds, icons and materials of LoadedType on the Weapon once its assets are in memory
+	void ApplyWeaponAssets(EWeaponType LoadedType);
+
 	void FinishMovingSlide();
 
 	void UpdateSlideDisplacement();
 
+	// Also ticks while falling upright after a throw and while the Pistol slide is moving
+	virtual bool NeedsTick() const override;
+
 private:
 	/* Variables for handling the ThrowWeaponTimer */
 	FTimerHandle ThrowWeaponTimer;
@@ -144,30 +266,14 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	int32 Ammo;
 
-	/* Maximum Ammo that our Weapon can hold */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	int32 MagazineCapacity;
-
 	/* Type of Weapon equipped by the Character */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	EWeaponType WeaponType;
 
-	/* The type of Ammo for this Weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	EAmmoType AmmoType;
-
-	/* FName for the Reload Montage Section */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	FName ReloadMontageSection;
-
 	/* True when moving the clip while reloading */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	bool bMovingClip;
 
-	/* Name for the clip bone of the EquippedWeapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	FName ClipBoneName;
-
 	/* Data table for Weapon properties */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
 	UDataTable* WeaponDataTable;
@@ -175,42 +281,6 @@ private:
 	/* Placeholder for clearing out the Material Index of the previously equipped Weapon */
 	int32 PreviousMaterialIndex;
 
-	/* Middle crosshair property of the currently equipped Weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsMiddle;
-
-	/* Left crosshair property of the currently equipped Weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsLeft;
-
-	/* Right crosshair property of the currently equipped Weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsRight;
-
-	/* Bottom crosshair property of the currently equipped Weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsBottom;
-
-	/* Top crosshair property of the currently equipped Weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsTop;
-
-	/* The speed at which automatic gun fire happens */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	float AutoFireRate;
-
-	/* Partice system spawned at the BarrelSocket of the Weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	UParticleSystem* MuzzleFlash;
-
-	/* Sound played with the Weapon is fired */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	USoundCue* FireSound;
-
-	/* Used on the Pistol to hide the Gun Mesh */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
-	FName BoneToHide;
-
 	/* Amount that the slide is pushed back during Pistol fire */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Pistol, meta = (AllowPrivateAccess = "true"))
 	float SlideDisplacement;
@@ -233,35 +303,25 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Pistol, meta = (AllowPrivateAccess = "true"))
 	float MaxSlideDisplacement;
 
-	/* True when the Weapon has automatic gun fire */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	bool bAutomatic;
-
-	/* Amount of damage caused by a bullet to the body */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	float Damage;
-
-	/* Amount of damaged caused by a bullet to the head */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	float HeadShotDamage;
+	/* Shared data for this Weapon's type, built once by UItemDataSubsystem */
+	TSharedPtr<const FWeaponDescriptor> Descriptor;
 
 public:
 	// Getters for private variables
-	FORCEINLINE bool GetAutomatic() const { return bAutomatic; }
-	FORCEINLINE EAmmoType GetAmmoType() const { return AmmoType; }
+	FORCEINLINE bool GetAutomatic() const { return Descriptor.IsValid() && Descriptor->Data.bAutomatic; }
+	FORCEINLINE EAmmoType GetAmmoType() const { return Descriptor.IsValid() ? Descriptor->Data.AmmoType : EAmmoType::EAT_9mm; }
 	FORCEINLINE EWeaponType GetWeaponType() const { return WeaponType; }
-	FORCEINLINE float GetAutoFireRate() const { return AutoFireRate; }
-	FORCEINLINE float GetDamage() const { return Damage; }
-	FORCEINLINE float GetHeadShotDamage() const { return HeadShotDamage; }
-	FORCEINLINE FName GetClipBoneName() const { return ClipBoneName; }
-	FORCEINLINE FName GetReloadMontageSection() const { return ReloadMontageSection; }
+	FORCEINLINE float GetAutoFireRate() const { return Descriptor.IsValid() ? Descriptor->Data.AutoFireRate : 0.1f; }
+	FORCEINLINE float GetDamage() const { return Descriptor.IsValid() ? Descriptor->Data.Damage : 0.f; }
+	FORCEINLINE float GetHeadShotDamage() const { return Descriptor.IsValid() ? Descriptor->Data.HeadShotDamage : 0.f; }
+	FORCEINLINE FName GetClipBoneName() const { return Descriptor.IsValid() ? Descriptor->Data.ClipBoneName : NAME_None; }
+	FORCEINLINE FName GetReloadMontageSection() const { return Descriptor.IsValid() ? Descriptor->Data.ReloadMontageSection : NAME_None; }
 	FORCEINLINE int32 GetAmmo() const { return Ammo; }
-	FORCEINLINE int32 GetMagazineCapacity() const { return MagazineCapacity; }
-	FORCEINLINE UParticleSystem* GetMuzzleFlash() const { return MuzzleFlash; }
-	FORCEINLINE USoundCue* GetFireSound() const { return FireSound; }
+	FORCEINLINE int32 GetMagazineCapacity() const { return Descriptor.IsValid() ? Descriptor->Data.MagazineCapacity : Ammo; }
+	FORCEINLINE UParticleSystem* GetMuzzleFlash() const { return Descriptor.IsValid() ? ResolveWeaponAsset(Descriptor->Data.MuzzleFlash) : nullptr; }
+	FORCEINLINE USoundCue* GetFireSound() const { return Descriptor.IsValid() ? ResolveWeaponAsset(Descriptor->Data.FireSound) : nullptr; }
+	FORCEINLINE const FWeaponDescriptor* GetDescriptor() const { return Descriptor.Get(); }
 
 	// Setters for private variables
-	FORCEINLINE void SetClipBoneName(FName Name) { ClipBoneName = Name; }
-	FORCEINLINE void SetReloadMontageSection(FName Section) { ReloadMontageSection = Section; }
 	FORCEINLINE void SetMovingClip(bool Move) { bMovingClip = Move; }
 };
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponPoolSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "BelicaBadass.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Weapons Reused"), STAT_PooledWeaponsReused, STATGROUP_BelicaBadass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Weapons Created"), STAT_PooledWeaponsCreated, STATGROUP_BelicaBadass);
+
+static FAutoConsoleCommandWithWorld DumpWeaponPoolsCommand(
+	TEXT("Belica.WeaponPool.Dump"),
+	TEXT("Logs active, free and high-water counts of the pooled weapons."),
+	ObjectPool::MakeDumpCommand<UWeaponPoolSubsystem>());
+
+UWeaponPoolSubsystem::UWeaponPoolSubsystem() :
+	MaxFreePerClass(8)
+{
+}
+
+void UWeaponPoolSubsystem::Deinitialize()
+{
+	Pools.Empty();
+	ActiveWeapons.Empty();
+
+	Super::Deinitialize();
+}
+
+AWeapon* UWeaponPoolSubsystem::AcquireWeapon(const FWeaponRecord& Record, const FTransform& SpawnTransform)
+{
+	if (Record.WeaponClass == nullptr) return nullptr;
+
+	FObjectPool& Pool{ Pools.FindOrAdd(Record.WeaponClass) };
+	Pool.FreeObjects.RemoveAll([](const UObject* Weapon) { return !IsValid(Weapon); });
+
+	// A free Weapon of the same type already has the right mesh and descriptor, move it to the end so PopFree takes it
+	const int32 SameTypeIndex{ Pool.FreeObjects.IndexOfByPredicate([&Record](const UObject* Weapon) { return CastChecked<AWeapon>(Weapon)->GetWeaponType() == Record.WeaponType; }) };
+	if (SameTypeIndex != INDEX_NONE) Pool.FreeObjects.Swap(SameTypeIndex, Pool.FreeObjects.Num() - 1);
+
+	AWeapon* Weapon{ Pool.PopFree<AWeapon>() };
+	if (Weapon)
+	{
+		INC_DWORD_STAT(STAT_PooledWeaponsReused);
+	}
+	else
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		Weapon = GetWorld()->SpawnActor<AWeapon>(Record.WeaponClass, SpawnTransform, SpawnParams);
+		if (Weapon == nullptr) return nullptr;
+
+		INC_DWORD_STAT(STAT_PooledWeaponsCreated);
+	}
+
+	Weapon->ResetFromRecord(Record, SpawnTransform);
+
+	Pool.MarkAcquired();
+	ActiveWeapons.Add(Weapon);
+
+	return Weapon;
+}
+
+void UWeaponPoolSubsystem::ReleaseWeapon(AWeapon* Weapon)
+{
+	if (!IsValid(Weapon)) return;
+
+	FObjectPool& Pool{ Pools.FindOrAdd(Weapon->GetClass()) };
+
+	// Weapons placed in the level join the pool here without ever having been handed out
+	if (ActiveWeapons.Remove(Weapon) > 0) Pool.MarkReleased();
+
+	if (!Pool.AddFree(Weapon, MaxFreePerClass))
+	{
+		Weapon->Destroy();
+		return;
+	}
+
+	Weapon->Deactivate();
+}
+
+void UWeaponPoolSubsystem::DumpPoolStats() const
+{
+	ObjectPool::DumpPoolStats(TEXT("Weapon"), Pools);
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Weapon.h"
+#include "ObjectPool.h"
+#include "WeaponPoolSubsystem.generated.h"
+
+/**
+ * Turns inventory records back into AWeapon actors and takes them back when they are put away,
+ * so only equipped or dropped weapons exist as actors and a bigger inventory costs no extra ticks,
+ * components or materials.
+ */
+UCLASS()
+class BELICABADASS_API UWeaponPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponPoolSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// Rehydrates the Weapon described by Record at SpawnTransform, reusing a pooled one when there is one
+	AWeapon* AcquireWeapon(const FWeaponRecord& Record, const FTransform& SpawnTransform);
+
+	// Deactivates Weapon and keeps it for the next Weapon of its class, Weapons picked up in the level join the pool here
+	void ReleaseWeapon(AWeapon* Weapon);
+
+	// Logs active, free and high-water counts for every weapon class
+	void DumpPoolStats() const;
+
+private:
+	/* Pool of weapons for each weapon class */
+	UPROPERTY()
+	TMap<UClass*, FObjectPool> Pools;
+
+	/* Weapons handed out by AcquireWeapon, only these count against a pool's active weapons when released */
+	TSet<TWeakObjectPtr<AWeapon>> ActiveWeapons;
+
+	/* Released weapons beyond this count are destroyed instead of pooled */
+	int32 MaxFreePerClass;
+};